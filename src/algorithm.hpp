@@ -2,7 +2,10 @@
 
 #include "math_types.hpp"
 
+#include <bkassert/assert.hpp>
+
 #include <algorithm>
+#include <array>
 #include <numeric>
 #include <type_traits>
 #include <memory>
@@ -181,4 +184,63 @@ constexpr int compare(T const& lhs, U const& rhs) noexcept {
                       : 1;
 }
 
+//! Stably sort @p values by the corresponding unsigned integral @p keys using an
+//! LSD radix sort; bytes which are the same for every key are skipped. Both
+//! containers are permuted and may have their storage swapped for temporaries.
+template <typename KeyContainer, typename ValueContainer>
+void radix_sort_by_key(KeyContainer& keys, ValueContainer& values) {
+    using key_t = typename KeyContainer::value_type;
+    static_assert(std::is_unsigned<key_t>::value, "");
+
+    auto const n = keys.size();
+    BK_ASSERT(n == values.size());
+
+    if (n < 2u) {
+        return;
+    }
+
+    // the bits which differ between any two keys
+    auto const varying = [&]() noexcept {
+        auto all_and = static_cast<key_t>(~key_t {0});
+        auto all_or  = key_t {0};
+
+        for (auto const k : keys) {
+            all_and &= k;
+            all_or  |= k;
+        }
+
+        return static_cast<key_t>(all_and ^ all_or);
+    }();
+
+    KeyContainer   keys_tmp(n);
+    ValueContainer values_tmp(n);
+
+    for (size_t shift = 0; shift < sizeof(key_t) * 8u; shift += 8u) {
+        if (((varying >> shift) & 0xFFu) == 0u) {
+            continue;
+        }
+
+        auto const digit = [shift](key_t const k) noexcept {
+            return static_cast<size_t>((k >> shift) & 0xFFu);
+        };
+
+        std::array<size_t, 257> offsets {};
+        for (auto const k : keys) {
+            ++offsets[digit(k) + 1u];
+        }
+
+        std::partial_sum(begin(offsets), end(offsets), begin(offsets));
+
+        for (size_t i = 0; i < n; ++i) {
+            auto const j = offsets[digit(keys[i])]++;
+            keys_tmp[j]   = keys[i];
+            values_tmp[j] = std::move(values[i]);
+        }
+
+        using std::swap;
+        swap(keys, keys_tmp);
+        swap(values, values_tmp);
+    }
+}
+
 } //namespace boken
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "memory_stats.hpp"
+
 #include "bkassert/assert.hpp"
 
 #include <utility>
@@ -13,7 +15,8 @@ namespace boken {
 
 //! fixed size block allocator
 //! @note this does not conform to the stl allocator interface
-template <typename T>
+//! @tparam Tag the subsystem the storage is accounted against.
+template <typename T, memory_tag Tag>
 class contiguous_fixed_size_block_storage {
     struct block_data_t {
         uint32_t next;
@@ -76,6 +79,47 @@ public:
         return result;
     }
 
+    //! allocate @p n new blocks with contiguous ids at the end of the storage.
+    //! Each block is constructed in place from the result of @p f(id).
+    //! Storage for all @p n blocks is reserved up front.
+    //! @returns the id of the first block allocated; ids are [id, id + n).
+    template <typename F>
+    size_t allocate_n(size_t const n, F&& f) {
+        auto const first = data_.size();
+        auto const last  = first + n;
+
+        data_.reserve(last);
+
+        try {
+            for (auto i = first; i < last; ++i) {
+                data_.emplace_back(construct_t {}, f(i + 1)); // ids start at 1
+            }
+        } catch (...) {
+            // block_t doesn't destroy its active member
+            while (data_.size() > first) {
+                data_.back().data.~T();
+                data_.pop_back();
+            }
+
+            throw;
+        }
+
+        // the list of free blocks is always terminated by the (old) size of
+        // the storage; relink it to the new size.
+        if (next_free_ == first) {
+            next_free_ = static_cast<uint32_t>(last);
+        } else {
+            auto i = next_free_;
+            while (data_[i].info.next != first) {
+                i = data_[i].info.next;
+            }
+
+            data_[i].info.next = static_cast<uint32_t>(last);
+        }
+
+        return first + 1; // ids start at 1
+    }
+
     //! free the block with the given id by calling its destructor
     void deallocate(size_t const i) noexcept {
         BK_ASSERT(i >= 1 && i <= data_.size()); // ids start at 1
@@ -92,7 +136,7 @@ public:
     T&       operator[](size_t const i)       noexcept { return data_[i - 1].data; }
     T const& operator[](size_t const i) const noexcept { return data_[i - 1].data; }
 private:
-    std::vector<block_t> data_;
+    tracked_vector<block_t, Tag> data_;
     uint32_t             next_free_ {};
 };
 
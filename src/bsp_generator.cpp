@@ -87,8 +87,9 @@ void bsp_generator_impl::generate(random_state& rng) {
     auto const split_variance = static_cast<double>(p.split_variance);
 
     for (size_t i = 0; i != nodes_.size(); ++i) {
-        node_t&     n = nodes_[i];
-        auto const& r = n.rect;
+        // nodes_ grows below; copy rather than refer to the current node
+        auto const n = nodes_[i];
+        auto const r = n.rect;
 
         // neither the need nor roll to split
         if (!must_slice_rect(r, max_w, max_h) && !pass_split_chance(r)) {
@@ -111,7 +112,7 @@ void bsp_generator_impl::generate(random_state& rng) {
         nodes_.push_back({child_rects.first,  parent, 0, 0});
         nodes_.push_back({child_rects.second, parent, 0, 0});
 
-        n.child = static_cast<uint16_t>(i + 1);
+        nodes_[i].child = static_cast<uint16_t>(i + 1);
     }
 
     std::stable_sort(std::begin(leaf_nodes_), std::end(leaf_nodes_)
@@ -2,13 +2,13 @@
 #   define CATCH_CONFIG_RUNNER
 #   include "catch.hpp"
 
-void boken::run_unit_tests() {
-    Catch::Session().run();
+void boken::run_unit_tests(int const argc, char const* const* const argv) {
+    Catch::Session().run(argc, argv);
 }
 
 #else
 
-void boken::run_unit_tests() {
+void boken::run_unit_tests(int, char const* const*) {
 
 }
 #endif //BK_NO_TESTS
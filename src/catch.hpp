@@ -19,6 +19,8 @@
 
 namespace boken {
 
-void run_unit_tests();
+//! Run the unit tests; the command line arguments are passed on to Catch,
+//! e.g. "[benchmark]" to run the (otherwise hidden) benchmarks.
+void run_unit_tests(int argc, char const* const* argv);
 
 } //namespace boken
@@ -68,6 +68,8 @@ enum class command_type : uint32_t {
 
   , debug_toggle_regions = djb2_hash_32c("debug_toggle_regions")
   , debug_teleport_self  = djb2_hash_32c("debug_teleport_self")
+  , debug_memory_stats   = djb2_hash_32c("debug_memory_stats")
+  , debug_profiler       = djb2_hash_32c("debug_profiler")
 };
 
 template <typename Enum>
@@ -5,6 +5,7 @@
 #include "serialize.hpp"
 #include "algorithm.hpp"
 #include "context_fwd.hpp"
+#include "memory_stats.hpp"
 
 #include "bkassert/assert.hpp"
 
@@ -45,11 +46,12 @@ private:
           : string_view {"{none such}"};
     }
 
-    void load_entity_defs_();
-    void load_item_defs_();
+    template <typename Key, typename Value>
+    using map_t = std::unordered_map<Key, Value, identity_hash, std::equal_to<Key>
+      , tracked_allocator<std::pair<Key const, Value>, memory_tag::data>>;
 
-    std::unordered_map<entity_id, entity_definition, identity_hash> entity_defs_;
-    std::unordered_map<item_id,   item_definition,   identity_hash> item_defs_;
+    map_t<entity_id, entity_definition> entity_defs_;
+    map_t<item_id,   item_definition>   item_defs_;
 
     struct property_data {
         serialize_data_type type;
@@ -57,8 +59,8 @@ private:
         int32_t             count;
     };
 
-    std::unordered_map<entity_property_id, property_data, identity_hash> entity_properties_;
-    std::unordered_map<item_property_id,   property_data, identity_hash> item_properties_;
+    map_t<entity_property_id, property_data> entity_properties_;
+    map_t<item_property_id,   property_data> item_properties_;
 
     tile_map tile_map_base_     {tile_map_type::base,   0, sizei32x {18}, sizei32y {18}, sizei32x {16}, sizei32y {16}};
     tile_map tile_map_entities_ {tile_map_type::entity, 1, sizei32x {18}, sizei32y {18}, sizei32x {26}, sizei32y {17}};
@@ -124,8 +126,8 @@ auto load_property_(Container& c) {
 
             if (it->second.type != type) {
                 //TODO type differs between property usages
-                printf("warning type differs for property \"%s\"\n"
-                     , string.data());
+                printf("warning type differs for property \"%.*s\"\n"
+                     , static_cast<int>(string.size()), string.data());
             }
 
             ++it->second.count;
@@ -136,19 +138,13 @@ auto load_property_(Container& c) {
 
 } // namespace
 
-void game_database_impl::load_entity_defs_() {
-    load_entity_definitions(load_definition_(entity_defs_, tile_map_entities_)
-                          , load_property_(entity_properties_));
-}
-
-void game_database_impl::load_item_defs_() {
-    load_item_definitions(load_definition_(item_defs_, tile_map_items_)
-                        , load_property_(item_properties_));
-}
-
+// the item and entity callbacks may run concurrently; each only touches its
+// own definitions, properties and tile map.
 game_database_impl::game_database_impl() {
-    load_entity_defs_();
-    load_item_defs_();
+    load_definitions(load_definition_(item_defs_, tile_map_items_)
+                   , load_property_(item_properties_)
+                   , load_definition_(entity_defs_, tile_map_entities_)
+                   , load_property_(entity_properties_));
 }
 
 item_definition const* find(game_database const& db, item_id const id) noexcept {
@@ -58,6 +58,7 @@ void merge_into_pile(
   , entity_descriptor const pile
 ) {
     merge_into_pile(ctx, std::move(itm_ptr), itm, pile.obj.items());
+    pile.obj.items_changed();
 }
 
 std::string name_of_decorated(
@@ -77,6 +78,25 @@ std::string name_of_decorated(
     return e.def->name;
 }
 
+bool append_name_of_decorated(
+    string_buffer_base&           buffer
+  , const_entity_descriptor const e
+) noexcept {
+    if (buffer.is_null()) {
+        return false;
+    }
+
+    if (!e) {
+        return buffer.append("{missing definition}");
+    }
+
+    constexpr auto p_is_player = property(entity_property::is_player);
+
+    return get_property_value_or(e, p_is_player, 0)
+      ? buffer.append("you")
+      : buffer.append("%s", e.def->name.data());
+}
+
 string_view name_of(const_context const ctx, const_entity_descriptor const e) noexcept {
     return e
       ? string_view {e.def->name}
@@ -143,6 +163,18 @@ unique_entity create_object(
     });
 }
 
+std::vector<unique_entity> create_objects(
+    game_database const&     db
+  , world&                   w
+  , entity_definition const& def
+  , random_state&            rng
+  , size_t const             n
+) {
+    return create_objects(w, n, [&](entity_instance_id const instance) {
+        return create_object(db, w, instance, def, rng);
+    });
+}
+
 namespace detail {
 
 bool impl_can_add_item(
@@ -187,27 +219,27 @@ bool impl_can_equip_item(
     }
 
     if (subject != itm_dest) {
-        return result.append("%s can't equip the %s to %s"
-          , name_of_decorated(ctx, subject).data()
-          , name_of_decorated(ctx, itm).data()
-          , name_of_decorated(ctx, itm_dest).data()), false;
+        return result.format("{} can't equip the {} to {}"
+          , subject
+          , itm
+          , itm_dest), false;
     }
 
     if (subject != itm_source) {
-        return result.append("%s can't equip the %s from %s"
-          , name_of_decorated(ctx, subject).data()
-          , name_of_decorated(ctx, itm).data()
-          , name_of_decorated(ctx, itm_source).data()), false;
+        return result.format("{} can't equip the {} from {}"
+          , subject
+          , itm
+          , itm_source), false;
     }
 
     if (!can_equip(itm)) {
-        return result.append("the %s can't be equipped"
-            , name_of_decorated(ctx, itm).data()), false;
+        return result.format("the {} can't be equipped"
+            , itm), false;
     }
 
     if (!can_equip(itm_dest)) {
-        return result.append("%s can't equip any items"
-            , name_of_decorated(ctx, itm_dest).data()), false;
+        return result.format("{} can't equip any items"
+            , itm_dest), false;
     }
 
     auto const last  = itm_dest->body_end();
@@ -215,8 +247,8 @@ bool impl_can_equip_item(
       , [&](body_part const& p) { return p.is_free(); });
 
     if (it == last) {
-        return result.append("%s has no free equipment slots"
-            , name_of_decorated(ctx, itm_dest).data()), false;
+        return result.format("{} has no free equipment slots"
+            , itm_dest), false;
     }
 
     return true;
@@ -256,9 +288,9 @@ bool impl_try_equip_item(
 
     itm_dest->equip(it->id, get_instance(itm.obj));
 
-    result.append("%s equip the %s to its %s."
-      , name_of_decorated(ctx, subject).data()
-      , name_of_decorated(ctx, itm).data()
+    result.format("{} equip the {} to its {}."
+      , subject
+      , itm
       , "{part}");
 
     return true;
@@ -317,9 +349,9 @@ bool impl_try_unequip_item(
 
     itm_source->unequip(get_instance(itm));
 
-    result.append("%s remove the %s from its %s."
-      , name_of_decorated(ctx, subject).data()
-      , name_of_decorated(ctx, itm).data()
+    result.format("{} remove the {} from its {}."
+      , subject
+      , itm
       , "{part}");
 
     return true;
@@ -425,11 +457,13 @@ void entity_equip_impl(Container&& parts, item_pile& source, item_instance_id co
 void entity::equip(item_instance_id const id) {
     entity_equip_impl(body_parts_, items(), id
       , [&](body_part const& part) { return part.is_free(); });
+    items_changed();
 }
 
 void entity::equip(body_part_id const part_id, item_instance_id const id) {
     entity_equip_impl(body_parts_, items(), id
       , [&](body_part const& part) { return part.id == part_id; });
+    items_changed();
 }
 
 
@@ -443,7 +477,7 @@ void entity::unequip(item_instance_id const id) {
 
     it->equip = item_instance_id {};
 
-    items().add_item({id, item_deleter_});
+    add_item({id, item_deleter_});
 }
 
 } //namespace boken
@@ -132,6 +132,7 @@ bool impl_try_unequip_item(
 
 //! returns whether the subject can equip the given item. If the subject can't,
 //! a formatted reason is written to the buffer given by result
+//! unless it is a null_string_buffer.
 inline bool can_equip_item(
     const_context                      const ctx
   , subject_t<const_entity_descriptor> const subject
@@ -184,6 +185,7 @@ inline bool try_equip_item(
 
 //! returns whether the subject can unequip the given item. If the subject can't,
 //! a formatted reason is written to the buffer given by result
+//! unless it is a null_string_buffer.
 inline bool can_unequip_item(
     const_context                      const ctx
   , subject_t<const_entity_descriptor> const subject
@@ -1,12 +1,18 @@
 #pragma once
 
 #include "config.hpp"
+#include "context_fwd.hpp"
+
+#include "bkassert/assert.hpp"
 
 #include <array>
 #include <string>
+#include <type_traits>
 
 #include <cstddef>
 #include <cstdarg>
+#include <cstdint>
+#include <cstring>
 
 namespace boken {
 
@@ -26,6 +32,59 @@ struct static_string_buffer_base {
 
 } // namespace detail
 
+//! Format @p value rounded to @p digits (at most 9) decimal places.
+struct fixed_t {
+    double value;
+    int    digits;
+};
+
+constexpr fixed_t fixed(double const value, int const digits = 2) noexcept {
+    return {value, digits};
+}
+
+//! Format @p value as "0x" followed by at least @p digits hex digits.
+struct hex_t {
+    uint64_t value;
+    int      digits;
+};
+
+constexpr hex_t hex(uint64_t const value, int const digits = 0) noexcept {
+    return {value, digits};
+}
+
+class string_buffer_base;
+
+namespace detail {
+
+template <typename T>
+std::enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value, bool>
+write_value(string_buffer_base& buffer, T value) noexcept;
+
+template <typename T>
+std::enable_if_t<std::is_integral<T>::value && std::is_unsigned<T>::value, bool>
+write_value(string_buffer_base& buffer, T value) noexcept;
+
+bool write_value(string_buffer_base& buffer, bool        value) noexcept;
+bool write_value(string_buffer_base& buffer, char        value) noexcept;
+bool write_value(string_buffer_base& buffer, double      value) noexcept;
+bool write_value(string_buffer_base& buffer, char const* value) noexcept;
+bool write_value(string_buffer_base& buffer, string_view value) noexcept;
+bool write_value(string_buffer_base& buffer, std::string const& value) noexcept;
+bool write_value(string_buffer_base& buffer, fixed_t     value) noexcept;
+bool write_value(string_buffer_base& buffer, hex_t       value) noexcept;
+
+//! Items and entities are written as their decorated name; this requires
+//! names.hpp.
+template <typename Object, typename Definition>
+bool write_value(string_buffer_base& buffer
+               , descriptor_base<Object, Definition> const& value) noexcept;
+
+//! @returns the number of "{}" in @p fmt, or -1 if it has a "{" which is
+//! neither "{}" nor "{{".
+ptrdiff_t format_placeholder_count(char const* fmt) noexcept;
+
+} // namespace detail
+
 class string_buffer_base {
 public:
     string_buffer_base(char* const data, size_t const capacity) noexcept
@@ -49,11 +108,61 @@ public:
 
 #undef BK_PRINTF_ATTRIBUTE
 
+    //! Append @p fmt with each "{}" replaced by the next of @p args, formatted
+    //! according to its type; "{{" is a literal "{". Unlike append, the format
+    //! string is only scanned for "{", and values are converted directly
+    //! without going through vsnprintf.
+    //! There must be exactly one "{}" for each of @p args; otherwise nothing is
+    //! appended. Nothing at all is done for a null buffer.
+    template <typename... Args>
+    bool format(char const* fmt, Args const&... args) noexcept {
+        using expand_t = bool const [];
+
+        if (detail::format_placeholder_count(fmt)
+                != static_cast<ptrdiff_t>(sizeof...(Args))) {
+            BK_ASSERT(false);
+            return false;
+        }
+
+        if (is_null()) {
+            return false;
+        }
+
+        bool ok = true;
+        (void)expand_t {true, (ok = ok
+            && format_next_(fmt)
+            && detail::write_value(*this, args))...};
+
+        return ok && format_next_(fmt);
+    }
+
+    //! Append each of @p args, formatted according to its type.
+    template <typename... Args>
+    bool write(Args const&... args) noexcept {
+        using expand_t = bool const [];
+
+        bool ok = true;
+        (void)expand_t {true, (ok = ok && detail::write_value(*this, args))...};
+
+        return ok;
+    }
+
+    bool write_string(char const* s, size_t n) noexcept;
+    bool write_int(int64_t n) noexcept;
+    bool write_uint(uint64_t n) noexcept;
+    bool write_fixed(double n, int digits) noexcept;
+    bool write_hex(uint64_t n, int digits) noexcept;
+
     void clear() noexcept {
-        first_   = 0;
-        data_[0] = '\0';
+        first_ = 0;
+        if (data_) {
+            data_[0] = '\0';
+        }
     }
 
+    //! true if the buffer has no storage; anything appended is discarded.
+    bool is_null() const noexcept { return !data_; }
+
     bool full()  const noexcept { return first_ >= capacity_ - 1; }
     bool empty() const noexcept { return first_ == 0; }
     size_t capacity() const noexcept { return static_cast<size_t>(capacity_); }
@@ -76,11 +185,72 @@ public:
         return std::string {data_, static_cast<size_t>(first_)};
     }
 private:
+    //! append the text of @p fmt up to the next "{}", or the end, and advance
+    //! @p fmt past it.
+    bool format_next_(char const*& fmt) noexcept;
+
     ptrdiff_t first_;
     char*     data_;
     ptrdiff_t capacity_;
 };
 
+namespace detail {
+
+template <typename T>
+std::enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value, bool>
+write_value(string_buffer_base& buffer, T const value) noexcept {
+    return buffer.write_int(value);
+}
+
+template <typename T>
+std::enable_if_t<std::is_integral<T>::value && std::is_unsigned<T>::value, bool>
+write_value(string_buffer_base& buffer, T const value) noexcept {
+    return buffer.write_uint(value);
+}
+
+inline bool write_value(string_buffer_base& buffer, bool const value) noexcept {
+    return value ? buffer.write_string("true", 4u) : buffer.write_string("false", 5u);
+}
+
+inline bool write_value(string_buffer_base& buffer, char const value) noexcept {
+    return buffer.write_string(&value, 1u);
+}
+
+inline bool write_value(string_buffer_base& buffer, double const value) noexcept {
+    return buffer.write_fixed(value, 2);
+}
+
+inline bool write_value(string_buffer_base& buffer, char const* const value) noexcept {
+    return buffer.write_string(value, std::strlen(value));
+}
+
+inline bool write_value(string_buffer_base& buffer, string_view const value) noexcept {
+    return buffer.write_string(value.data(), value.size());
+}
+
+inline bool write_value(string_buffer_base& buffer, std::string const& value) noexcept {
+    return buffer.write_string(value.data(), value.size());
+}
+
+inline bool write_value(string_buffer_base& buffer, fixed_t const value) noexcept {
+    return buffer.write_fixed(value.value, value.digits);
+}
+
+inline bool write_value(string_buffer_base& buffer, hex_t const value) noexcept {
+    return buffer.write_hex(value.value, value.digits);
+}
+
+template <typename Object, typename Definition>
+bool write_value(
+    string_buffer_base&                        buffer
+  , descriptor_base<Object, Definition> const& value
+) noexcept {
+    // found by ADL; declared in names.hpp
+    return append_name_of_decorated(buffer, value);
+}
+
+} // namespace detail
+
 template <size_t N>
 class static_string_buffer
   : public  string_buffer_base
@@ -101,4 +271,14 @@ public:
     }
 };
 
+//! A buffer which discards anything appended to it. Functions which optionally
+//! produce text check is_null() and skip producing it altogether.
+class null_string_buffer final : public string_buffer_base {
+public:
+    null_string_buffer() noexcept
+      : string_buffer_base {nullptr, 0}
+    {
+    }
+};
+
 } // namespace boken
@@ -1,10 +1,13 @@
 #pragma once
 
-namespace boken {
-
+#include <memory>
 #include <type_traits>
 #include <utility>
 
+#include <cstddef>
+
+namespace boken {
+
 //! Type trait for the number of parameters a function (object) takes.
 template <typename F>
 struct arity_of;
@@ -72,4 +75,44 @@ auto void_as_bool(F&& f) noexcept {
   return void_as_bool_t<Result, F> {std::forward<F>(f)};
 }
 
+template <typename Signature>
+class function_ref;
+
+//! A non-owning, non-allocating reference to a callable object.
+//! Intended as a replacement for std::function const& for callbacks that are
+//! invoked only for the duration of a call.
+//! @note The referenced callable must outlive the function_ref.
+template <typename R, typename... Args>
+class function_ref<R (Args...)> {
+    template <typename F>
+    using is_compatible = std::integral_constant<bool,
+        !std::is_same<std::decay_t<F>, function_ref>::value
+     && (std::is_void<R>::value
+      || std::is_convertible<
+            decltype(std::declval<F&>()(std::declval<Args>()...)), R>::value)>;
+
+    template <typename F>
+    static R invoke_(void* const f, Args... args) {
+        return static_cast<R>(
+            (*static_cast<std::add_pointer_t<F>>(f))(std::forward<Args>(args)...));
+    }
+public:
+    template <typename F, typename = std::enable_if_t<is_compatible<F>::value>>
+    function_ref(F&& f) noexcept
+      : obj_  {const_cast<void*>(static_cast<void const*>(std::addressof(f)))}
+      , call_ {&invoke_<std::remove_reference_t<F>>}
+    {
+    }
+
+    function_ref(function_ref const&) noexcept = default;
+    function_ref& operator=(function_ref const&) noexcept = default;
+
+    R operator()(Args... args) const {
+        return call_(obj_, std::forward<Args>(args)...);
+    }
+private:
+    void* obj_;
+    R (*call_)(void*, Args...);
+};
+
 } // namespace boken
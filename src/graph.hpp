@@ -1,6 +1,7 @@
 #pragma once
 
 #include "math_types.hpp"
+#include "memory_stats.hpp"
 
 #include "bkassert/assert.hpp"
 
@@ -430,7 +431,7 @@ private:
         }
     };
 
-    std::priority_queue<cost_t, std::vector<cost_t>, greater> pqueue_;
+    std::priority_queue<cost_t, tracked_vector<cost_t, memory_tag::pathing>, greater> pqueue_;
 
     // XX'YY'CCCC'CCCCCCCC'CCCCCCCC'CCCCCCCC
     // 28 bits for cost, 4 bits for "from" direction
@@ -438,7 +439,7 @@ private:
     // 01 ->  0
     // 10 ->  1
     // 11 -> -1
-    std::vector<uint32_t> data_;
+    tracked_vector<uint32_t, memory_tag::pathing> data_;
 };
 
 template <typename Graph>
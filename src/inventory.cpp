@@ -3,6 +3,8 @@
 #include "text.hpp"
 #include "math.hpp"
 #include "rect.hpp"
+#include "memory_stats.hpp"
+#include "item.hpp"
 
 #include "bkassert/assert.hpp"
 
@@ -72,6 +74,8 @@ public:
 
     //--------------------------------------------------------------------------
     void set_title(std::string title) final override {
+        ++version_;
+
         title_.layout(trender_, std::move(title));
     }
 
@@ -91,20 +95,48 @@ public:
     recti32 cell_bounds(int const c, int const r) const noexcept final override {
         BK_ASSERT(check_col_(c) && check_row_(r));
 
-        auto const bounds = (row(r).first + c)->extent();
         auto const v = metrics_.frame.top_left() - point2i32 {};
+        return cell_rect_(static_cast<size_t>(c), static_cast<size_t>(r)) + v;
+    }
+
+    sizei32y row_height() const noexcept final override {
+        return sizei32y {trender_.line_gap()};
+    }
+
+    std::pair<int, int> visible_rows() const noexcept final override {
+        auto const row_h = value_cast(row_height());
+        auto const n     = static_cast<int32_t>(rows());
+
+        // the visible part of the client area relative to the first row
+        auto const y0 = value_cast(scroll_pos_.y - metrics_.header_h);
+        auto const y1 = y0 + value_cast(metrics_.client_frame.height());
+
+        if (row_h <= 0 || n <= 0 || y1 <= 0) {
+            return {0, 0};
+        }
+
+        auto const first = std::max(0, y0 / row_h);
+        auto const last  = std::min(n, (y1 + row_h - 1) / row_h);
 
-        return bounds + v;
+        return {std::min(first, last), last};
+    }
+
+    uint32_t version() const noexcept final override {
+        return version_;
     }
 
     //--------------------------------------------------------------------------
     bool show() noexcept final override {
+        ++version_;
+
         bool const result = is_visible_;
         is_visible_ = true;
         return result;
     }
 
     bool hide() noexcept final override {
+        ++version_;
+
         bool const result = is_visible_;
         is_visible_ = false;
         return result;
@@ -115,6 +147,8 @@ public:
     }
 
     bool toggle_visible() noexcept final override {
+        ++version_;
+
         bool const result = is_visible_;
         is_visible_ = !is_visible_;
         return result;
@@ -139,6 +173,8 @@ public:
 
     //--------------------------------------------------------------------------
     void scroll_by(sizei32y const dy) noexcept final override {
+        ++version_;
+
         auto const h = metrics_.client_frame.height();
 
         if (content_h_ <= h) {
@@ -151,6 +187,8 @@ public:
     }
 
     void scroll_by(sizei32x const dx) noexcept final override {
+        ++version_;
+
         auto const w = metrics_.client_frame.width();
 
         if (content_w_ <= w) {
@@ -163,6 +201,8 @@ public:
     }
 
     void scroll_into_view(int const c, int const r) noexcept final override {
+        ++version_;
+
         if (empty()) {
             BK_ASSERT(c == 0 && r == 0);
             return;
@@ -176,7 +216,7 @@ public:
         auto const frame = metrics_.client_frame;
 
         // translate the cell into screen space
-        auto const cell = get_row_(ri)[ci].extent()
+        auto const cell = cell_rect_(ci, ri)
             + (frame.top_left() - point2i32 {})
             - scroll_offset();
 
@@ -203,6 +243,8 @@ public:
 
     //--------------------------------------------------------------------------
     void resize_to(sizei32x const w, sizei32y const h) noexcept final override {
+        ++version_;
+
         auto&       m = metrics_;
         auto const& c = config_;
 
@@ -270,6 +312,8 @@ public:
     }
 
     void move_by(vec2i32 const v) noexcept final override {
+        ++version_;
+
         auto& m = metrics_;
 
         m.frame        += v;
@@ -289,6 +333,8 @@ public:
     }
 
     int indicate(int const n) noexcept final override {
+        ++version_;
+
         BK_ASSERT(n >= 0);
         auto const r = static_cast<int>(rows());
 
@@ -299,6 +345,8 @@ public:
     }
 
     int indicate_change_(int const n) noexcept {
+        ++version_;
+
         auto const result = indicated_;
 
         auto const n_rows = rows();
@@ -328,70 +376,65 @@ public:
 
     //--------------------------------------------------------------------------
     void sort(std::initializer_list<int> const cols) noexcept final override {
-        std::sort(begin(sorted_), end(sorted_), [&](size_t const lhs, size_t const rhs) {
-            for (int const c : cols) {
-                BK_ASSERT(c != 0);
-
-                auto const ascending = c > 0;
-                auto const i = static_cast<size_t>((ascending ? c : -c) - 1);
-
-                auto const lhs_t = rows_[lhs][i].text();
-                auto const lhs_i = row_data_[lhs].id;
-                auto const lhs_d = const_item_descriptor {ctx_, lhs_i};
-
-                auto const rhs_t = rows_[rhs][i].text();
-                auto const rhs_i = row_data_[rhs].id;
-                auto const rhs_d = const_item_descriptor {ctx_, rhs_i};
-
-                auto const n = cols_[i].sorter(lhs_d, lhs_t, rhs_d, rhs_t);
-                if (n < 0) {
-                    return ascending;
-                } else if (n > 0) {
-                    return !ascending;
-                }
-            }
-
-            return false;
-        });
+        sort(cols.begin(), cols.end());
     }
 
     void sort(int const* const first, int const* const last) noexcept final override {
         BK_ASSERT(( !first &&  !last)
                || (!!first && !!last));
 
-        // sort by the order in which the items were originally added to the
-        // list
-        if (!first) {
-            std::iota(begin(sorted_), end(sorted_), int16_t {0});
+        sort_cols_.assign(first, last);
+        sort_();
+    }
+
+    void resort() noexcept final override {
+        if (unsorted_.empty()) {
             return;
         }
 
-        std::sort(begin(sorted_), end(sorted_), [&](size_t const lhs, size_t const rhs) {
-            for (auto it = first; it != last; ++it) {
-                auto const c = *it;
-                BK_ASSERT(c != 0);
+        // rows are kept in the order they were added; new rows already come
+        // last, and changed rows stay where they are
+        if (sort_cols_.empty()) {
+            unsorted_.clear();
+            return;
+        }
 
-                auto const ascending = c > 0;
-                auto const i = static_cast<size_t>((ascending ? c : -c) - 1);
+        // each row out of place costs a search and an insertion; with enough
+        // of them, sorting everything again is cheaper
+        if (unsorted_.size() * 8u > sorted_.size()) {
+            sort_();
+            return;
+        }
+
+        ++version_;
 
-                auto const lhs_t = rows_[lhs][i].text();
-                auto const lhs_i = row_data_[lhs].id;
-                auto const lhs_d = const_item_descriptor {ctx_, lhs_i};
+        // take the rows out of place out of the order, and put each back in
+        // turn; a row may be listed more than once
+        remap_.assign(rows_.size(), int16_t {0});
+        for (auto const r : unsorted_) {
+            remap_[static_cast<size_t>(r)] = 1;
+        }
 
-                auto const rhs_t = rows_[rhs][i].text();
-                auto const rhs_i = row_data_[rhs].id;
-                auto const rhs_d = const_item_descriptor {ctx_, rhs_i};
+        erase_if(sorted_, [&](int16_t const r) noexcept {
+            return remap_[static_cast<size_t>(r)] != 0; });
 
-                auto const n = cols_[i].sorter(lhs_d, lhs_t, rhs_d, rhs_t);
-                if (n < 0) {
-                    return ascending;
-                } else if (n > 0) {
-                    return !ascending;
-                }
+        for (auto const r : unsorted_) {
+            auto& state = remap_[static_cast<size_t>(r)];
+            if (state != 1) {
+                continue;
             }
 
-            return false;
-        });
+            state = 2;
+
+            auto const it = std::upper_bound(begin(sorted_), end(sorted_), r
+              , [&](int16_t const lhs, int16_t const rhs) noexcept {
+                    return is_row_before_(static_cast<size_t>(lhs), static_cast<size_t>(rhs));
+                });
+
+            sorted_.insert(it, r);
+        }
+
+        unsorted_.clear();
     }
 
     //--------------------------------------------------------------------------
@@ -409,17 +452,31 @@ public:
       , sizei16x    width
     ) final override;
 
+    void add_column(
+        uint8_t     id
+      , std::string label
+      , get_f       get
+      , key_f       key
+      , int         insert_before
+      , sizei16x    width
+    ) final override;
+
     void add_row(item_instance_id const id) final override {
         add_rows(&id, &id + 1);
     }
 
     void add_rows(item_instance_id const* const first, item_instance_id const* const last) final override {
+        ++version_;
+
         BK_ASSERT(!!first && !!last);
 
         auto const first_col = begin(cols_);
         auto const last_col  = end(cols_);
         auto const n_cols    = cols();
 
+        // only the width of each cell is needed until the row is drawn, and
+        // the font is fixed width, so it's estimated rather than measured; the
+        // text is laid out, as required, by row().
         auto const make_row = [&](item_instance_id const id) {
             row_t row;
             row.reserve(n_cols);
@@ -427,19 +484,36 @@ public:
             auto const i = const_item_descriptor {ctx_, id};
 
             std::transform(first_col, last_col, back_inserter(row)
-              , [&](col_data const& col) -> text_layout {
-                    return {trender_, col.getter(i), col.max_width, sizei16y {}};
+              , [&](col_data& col) -> cell_t {
+                    auto text = col.getter(i);
+                    auto const w = estimate_text_width(trender_, text, col.max_width);
+
+                    col.widest = std::max(col.widest, w);
+
+                    return {std::move(text)
+                          , w
+                          , col.key ? col.key(i) : int64_t {0}};
                 });
 
             return row;
         };
 
         auto const make_data = [&](item_instance_id const id) {
-            return row_data_t {id, false};
+            auto const i = const_item_descriptor {ctx_, id};
+            return row_data_t {id, i.obj.version(), false};
         };
 
-        std::generate_n(back_inserter(sorted_), std::distance(first, last)
-          , [n = static_cast<int16_t>(rows_.size())]() mutable { return n++; });
+        auto const n = std::distance(first, last);
+        auto const r = static_cast<int16_t>(rows_.size());
+
+        std::generate_n(back_inserter(sorted_), n
+          , [i = r]() mutable { return i++; });
+
+        // new rows go last until they are put in place by resort
+        if (!sort_cols_.empty()) {
+            std::generate_n(back_inserter(unsorted_), n
+              , [i = r]() mutable { return i++; });
+        }
 
         std::transform(first, last, back_inserter(rows_), make_row);
         std::transform(first, last, back_inserter(row_data_), make_data);
@@ -450,46 +524,149 @@ public:
     }
 
     void remove_rows(int const* const first, int const* const last) noexcept final override {
+        ++version_;
+
         BK_ASSERT(!!first && !!last);
 
+        if (first == last) {
+            return;
+        }
+
         std::for_each(first, last, [&](int const i) noexcept {
             BK_ASSERT(check_row_(i));
-            auto const j = static_cast<size_t>(i);
 
-            rows_[j].clear();
-            row_data_[j] = row_data_t {};
+            auto const r = sorted_index_(i);
+            row_data_[r].id = item_instance_id {};
+
+            // if this row was the widest, the next widest is unknown
+            for (size_t c = 0; c < cols(); ++c) {
+                if (rows_[r][c].width == cols_[c].widest) {
+                    widest_stale_ = true;
+                }
+            }
         });
 
+        // the new index of each remaining row
+        remap_.resize(rows_.size());
+        for (size_t r = 0, n = 0; r < rows_.size(); ++r) {
+            remap_[r] = (row_data_[r].id == item_instance_id {})
+              ? int16_t {-1}
+              : static_cast<int16_t>(n++);
+        }
+
         auto const i = indicated();
 
-        erase_if(rows_, [](auto const& row) noexcept {
-            return row.empty(); });
+        erase_if(sorted_, [&](int16_t const r) noexcept {
+            return remap_[static_cast<size_t>(r)] < 0; });
+
+        for (auto& r : sorted_) {
+            r = remap_[static_cast<size_t>(r)];
+        }
 
-        erase_if(row_data_, [](auto const& row) noexcept {
-            return row.id == item_instance_id {}; });
+        erase_if(unsorted_, [&](int16_t const r) noexcept {
+            return remap_[static_cast<size_t>(r)] < 0; });
+
+        for (auto& r : unsorted_) {
+            r = remap_[static_cast<size_t>(r)];
+        }
+
+        erase_if(row_layouts_, [&](row_layout_t const& r) noexcept {
+            return remap_[r.row] < 0; });
+
+        for (auto& r : row_layouts_) {
+            r.row = static_cast<size_t>(remap_[r.row]);
+        }
+
+        for (size_t r = 0; r < rows_.size(); ++r) {
+            auto const to = remap_[r];
+            if (to < 0 || static_cast<size_t>(to) == r) {
+                continue;
+            }
+
+            rows_[static_cast<size_t>(to)]     = std::move(rows_[r]);
+            row_data_[static_cast<size_t>(to)] = row_data_[r];
+        }
+
+        auto const remaining = sorted_.size();
+        rows_.erase(begin(rows_) + static_cast<ptrdiff_t>(remaining), end(rows_));
+        row_data_.erase(begin(row_data_) + static_cast<ptrdiff_t>(remaining), end(row_data_));
 
         auto const n = static_cast<int>(rows());
         if (n > 0) {
-            indicate(std::min(n, i));
+            indicate(std::min(n - 1, i));
         }
     }
 
+    int refresh(int const* const first, int const* const last) final override {
+        BK_ASSERT(!!first && !!last);
+
+        int result = 0;
+
+        for (auto it = first; it != last; ++it) {
+            BK_ASSERT(check_row_(*it));
+
+            auto const r    = sorted_index_(*it);
+            auto&      data = row_data_[r];
+            auto const i    = const_item_descriptor {ctx_, data.id};
+            auto const v    = i.obj.version();
+
+            if (v == data.version) {
+                continue;
+            }
+
+            data.version = v;
+            ++result;
+
+            // the sort keys are re-evaluated along with the text
+            if (!sort_cols_.empty()) {
+                unsorted_.push_back(static_cast<int16_t>(r));
+            }
+
+            if (update_cells_(r, i)) {
+                erase_if(row_layouts_, [r](row_layout_t const& l) noexcept {
+                    return l.row == r; });
+            }
+        }
+
+        if (result) {
+            ++version_;
+        }
+
+        return result;
+    }
+
     void clear_rows() noexcept final override {
+        ++version_;
+
         scroll_pos_.y = 0;
         rows_.clear();
+        row_layouts_.clear();
         row_data_.clear();
         sorted_.clear();
+        unsorted_.clear();
         indicated_ = 0;
+
+        for (auto& col : cols_) {
+            col.widest = sizei16x {};
+        }
+
+        widest_stale_ = false;
     }
 
     void clear() noexcept final override {
+        ++version_;
+
         scroll_pos_.x = 0;
         clear_rows();
         cols_.clear();
+        row_layouts_.clear();
+        sort_cols_.clear();
     }
 
     //--------------------------------------------------------------------------
     bool selection_toggle(int const row) final override {
+        ++version_;
+
         BK_ASSERT(check_row_(row));
         return get_row_data_(row).selected = !get_row_data_(row).selected;
     }
@@ -500,6 +677,8 @@ public:
     }
 
     void selection_union(std::initializer_list<int> const rows) final override {
+        ++version_;
+
         for_each_index_of(sorted_, begin(rows), end(rows), [&](auto const i) {
             BK_ASSERT(i >= 0);
             row_data_[static_cast<size_t>(i)].selected = true;
@@ -507,6 +686,8 @@ public:
     }
 
     int selection_clear() final override {
+        ++version_;
+
         int n = 0;
         for (auto& row : row_data_) {
             if (row.selected) {
@@ -562,11 +743,7 @@ public:
 
     //--------------------------------------------------------------------------
     std::pair<text_layout const*, text_layout const*>
-    row(int const index) const noexcept final override {
-        BK_ASSERT(check_row_(index));
-        auto const& row = get_row_(index);
-        return {row.data(), row.data() + row.size()};
-    }
+    row(int const index) const noexcept final override;
 
     item_instance_id row_data(int const index) const noexcept final override {
         BK_ASSERT(check_row_(index));
@@ -592,20 +769,244 @@ private:
         text_layout text;
         get_f       getter;
         sort_f      sorter;
+        key_f       key;
         offi16x     left;
         offi16x     right;
         sizei16x    min_width;
         sizei16x    max_width;
+        sizei16x    widest; //!< the widest cell; see widest_stale_
         uint8_t     id;
     };
 
-    using row_t = std::vector<text_layout>;
+    struct cell_t {
+        std::string text;
+        sizei16x    width; //!< the estimated width of text once laid out
+        int64_t     key;   //!< the sort key if the column has a key_f
+    };
+
+    using row_t = tracked_vector<cell_t, memory_tag::ui>;
+
+    //! The laid out text of a row. Only rows which are actually drawn are laid
+    //! out, and a small pool of these is recycled between them.
+    struct row_layout_t {
+        tracked_vector<text_layout, memory_tag::ui> cells;
+        size_t   row;       //!< the index in rows_
+        uint32_t last_used; //!< the value of row_layout_tick_ when last used
+    };
+
+    //! the maximum number of rows kept laid out; those visible plus some
+    //! margin for scrolling back and forth.
+    size_t row_layout_capacity_() const noexcept {
+        auto const row_h = std::max(1, value_cast(row_height()));
+        auto const h     = value_cast(metrics_.client_frame.height());
+        return static_cast<size_t>(std::max(0, h / row_h) + 2 + 16);
+    }
+
+    //! @returns the bounds of the cell at (@p c, @p r) relative to the client
+    //! area, ignoring the scroll position.
+    recti32 cell_rect_(size_t const c, size_t const r) const noexcept {
+        auto const& col   = cols_[c];
+        auto const  row_h = value_cast(row_height());
+        auto const  y     = value_cast(metrics_.header_h)
+                          + static_cast<int32_t>(r) * row_h;
+
+        return {offi32x {col.left}, offi32y {y}
+              , offi32x {col.right}, offi32y {y + row_h}};
+    }
 
     struct row_data_t {
         item_instance_id id;
+        uint32_t         version;  //!< the version of the item when last updated
         bool             selected;
     };
 
+    //! re-evaluate each cell of row @p r from @p i.
+    //! @returns true if the text of any cell has changed.
+    bool update_cells_(size_t const r, const_item_descriptor const i) {
+        bool result = false;
+
+        for (size_t c = 0; c < cols(); ++c) {
+            auto&       col  = cols_[c];
+            auto&       cell = rows_[r][c];
+
+            if (col.key) {
+                cell.key = col.key(i);
+            }
+
+            auto text = col.getter(i);
+            if (text == cell.text) {
+                continue;
+            }
+
+            auto const w = estimate_text_width(trender_, text, col.max_width);
+            if (w < cell.width && cell.width == col.widest) {
+                widest_stale_ = true;
+            }
+
+            col.widest = std::max(col.widest, w);
+            cell.width = w;
+            cell.text  = std::move(text);
+            result = true;
+        }
+
+        return result;
+    }
+
+    void add_column_(
+        uint8_t     id
+      , std::string label
+      , get_f       get
+      , sort_f      sort
+      , key_f       key
+      , int         insert_before
+      , sizei16x    width);
+
+    //! sort every row by sort_cols_.
+    void sort_() noexcept {
+        ++version_;
+
+        unsorted_.clear();
+
+        auto const first = sort_cols_.data();
+        auto const last  = sort_cols_.data() + sort_cols_.size();
+
+        // sort by the order in which the items were originally added to the
+        // list
+        if (first == last) {
+            std::iota(begin(sorted_), end(sorted_), int16_t {0});
+            return;
+        }
+
+        // a stable sort for each column, from the least to the most
+        // significant, gives the same order as comparing each column in turn.
+        for (auto it = last; it != first; ) {
+            auto const c = *--it;
+            BK_ASSERT(c != 0);
+
+            auto const ascending = c > 0;
+            auto const i = static_cast<size_t>((ascending ? c : -c) - 1);
+            BK_ASSERT(check_col_(i));
+
+            if (!cols_[i].key && cols_[i].sorter) {
+                sort_by_sorter_(i, ascending);
+            } else {
+                sort_by_key_(i, ascending);
+            }
+        }
+    }
+
+    //! @returns true if the row at @p lhs comes before the row at @p rhs, both
+    //! indices in rows_, in the order given by sort_cols_; equivalent to the
+    //! order sort_ gives.
+    bool is_row_before_(size_t const lhs, size_t const rhs) const noexcept {
+        for (auto const c : sort_cols_) {
+            auto const ascending = c > 0;
+            auto const i = static_cast<size_t>((ascending ? c : -c) - 1);
+
+            auto const n = compare_cells_(i, lhs, rhs);
+            if (n) {
+                return ascending ? (n < 0) : (n > 0);
+            }
+        }
+
+        return false;
+    }
+
+    //! compare the cells in column @p c of the rows at @p lhs and @p rhs.
+    //! @returns < 0, 0, or > 0 as for sort_f.
+    int compare_cells_(size_t const c, size_t const lhs, size_t const rhs) const noexcept {
+        auto const& col = cols_[c];
+        auto const& a   = rows_[lhs][c];
+        auto const& b   = rows_[rhs][c];
+
+        if (!col.key && col.sorter) {
+            return col.sorter(const_item_descriptor {ctx_, row_data_[lhs].id}, string_view {a.text}
+                            , const_item_descriptor {ctx_, row_data_[rhs].id}, string_view {b.text});
+        }
+
+        if (col.key) {
+            return (a.key < b.key) ? -1 : (b.key < a.key) ? 1 : 0;
+        }
+
+        return string_view {a.text}.compare(string_view {b.text});
+    }
+
+    //! stable sort sorted_ by column @p c using the column's sort_f.
+    void sort_by_sorter_(size_t const c, bool const ascending) {
+        std::stable_sort(begin(sorted_), end(sorted_)
+          , [&](size_t const lhs, size_t const rhs) {
+                auto const lhs_t = string_view {rows_[lhs][c].text};
+                auto const lhs_d = const_item_descriptor {ctx_, row_data_[lhs].id};
+
+                auto const rhs_t = string_view {rows_[rhs][c].text};
+                auto const rhs_d = const_item_descriptor {ctx_, row_data_[rhs].id};
+
+                auto const n = cols_[c].sorter(lhs_d, lhs_t, rhs_d, rhs_t);
+                return ascending ? (n < 0) : (n > 0);
+            });
+    }
+
+    //! stable sort sorted_ by column @p c using either the cached key for each
+    //! cell, or the rank of the cell's text amongst all the cells in the
+    //! column.
+    void sort_by_key_(size_t const c, bool const ascending) {
+        auto const n = sorted_.size();
+        sort_keys_.resize(n);
+
+        if (cols_[c].key) {
+            // flip the sign bit so that the order is preserved as unsigned
+            std::transform(begin(sorted_), end(sorted_), begin(sort_keys_)
+              , [&](int16_t const r) noexcept {
+                    auto const k = rows_[static_cast<size_t>(r)][c].key;
+                    return static_cast<uint64_t>(k) ^ (uint64_t {1} << 63);
+                });
+        } else {
+            rank_text_(c);
+            std::transform(begin(sorted_), end(sorted_), begin(sort_keys_)
+              , [&](int16_t const r) noexcept {
+                    return uint64_t {text_ranks_[static_cast<size_t>(r)]};
+                });
+        }
+
+        if (!ascending) {
+            for (auto& k : sort_keys_) {
+                k = ~k;
+            }
+        }
+
+        radix_sort_by_key(sort_keys_, sorted_);
+    }
+
+    //! fill text_ranks_ with the rank of the text of each cell in column @p c
+    //! such that equal strings have equal ranks.
+    void rank_text_(size_t const c) {
+        auto const n = rows_.size();
+
+        text_order_.resize(n);
+        std::iota(begin(text_order_), end(text_order_), uint32_t {0});
+
+        auto const text_at = [&](uint32_t const r) noexcept {
+            return string_view {rows_[r][c].text};
+        };
+
+        std::sort(begin(text_order_), end(text_order_)
+          , [&](uint32_t const lhs, uint32_t const rhs) noexcept {
+                return text_at(lhs) < text_at(rhs);
+            });
+
+        text_ranks_.resize(n);
+
+        uint32_t rank = 0;
+        for (size_t i = 0; i < n; ++i) {
+            auto const r = text_order_[i];
+            if (i && text_at(text_order_[i - 1]) != text_at(r)) {
+                ++rank;
+            }
+
+            text_ranks_[r] = rank;
+        }
+    }
+
     const_context  ctx_;
     text_renderer& trender_;
 
@@ -619,31 +1020,42 @@ private:
     text_layout title_;
 
     std::vector<col_data>   cols_;
-    std::vector<row_t>      rows_;
-    std::vector<row_data_t> row_data_;
-    std::vector<int16_t>    sorted_;
+    tracked_vector<row_t,      memory_tag::ui> rows_;
+    tracked_vector<row_layout_t, memory_tag::ui> mutable row_layouts_;
+    uint32_t mutable row_layout_tick_ {0};
+    tracked_vector<row_data_t, memory_tag::ui> row_data_;
+    tracked_vector<int16_t,    memory_tag::ui> sorted_;
+
+    //!< the columns given to the last sort
+    tracked_vector<int,        memory_tag::ui> sort_cols_;
+
+    //!< rows added or refreshed since the last sort; indices in rows_
+    tracked_vector<int16_t,    memory_tag::ui> unsorted_;
+
+    //!< true if a cell which was the widest in its column has since shrunk or
+    //!< been removed, so that col_data::widest may be too wide
+    bool widest_stale_ {false};
+
+    //!< temporary buffer used by remove_rows
+    tracked_vector<int16_t,    memory_tag::ui> remap_;
+
+    //!< temporary buffers used by sort
+    tracked_vector<uint64_t,   memory_tag::ui> sort_keys_;
+    tracked_vector<uint32_t,   memory_tag::ui> text_order_;
+    tracked_vector<uint32_t,   memory_tag::ui> text_ranks_;
 
     //!< temporary buffer used by get_selection
     std::vector<int> mutable selected_;
 
-    int  indicated_  {0};
-    bool is_visible_ {true};
+    int      indicated_  {0};
+    bool     is_visible_ {true};
+    uint32_t version_    {0};
 private:
     template <typename T>
     size_t sorted_index_(T const index) const noexcept {
         return static_cast<size_t>(sorted_[static_cast<size_t>(index)]);
     }
 
-    template <typename T>
-    row_t& get_row_(T const index) noexcept {
-        return rows_[sorted_index_(index)];
-    }
-
-    template <typename T>
-    row_t const& get_row_(T const index) const noexcept {
-        return const_cast<inventory_list_impl*>(this)->get_row_(index);
-    }
-
     template <typename T>
     row_data_t& get_row_data_(T const index) noexcept {
         return row_data_[sorted_index_(index)];
@@ -662,14 +1074,17 @@ std::unique_ptr<inventory_list> make_inventory_list(
     return std::make_unique<inventory_list_impl>(ctx, trender);
 }
 
-void inventory_list_impl::add_column(
+void inventory_list_impl::add_column_(
     uint8_t const  id
   , std::string    label
   , get_f          get
   , sort_f         sort
+  , key_f          key
   , int const      insert_before
   , sizei16x const width
 ) {
+    ++version_;
+
     auto const index = [&]() noexcept -> size_t {
         if (insert_before == insert_at_end) {
             return cols();
@@ -693,6 +1108,12 @@ void inventory_list_impl::add_column(
 
     auto text = text_layout {trender_, std::move(label), max_w, sizei16y {}};
 
+    row_layouts_.clear();
+
+    // the column indices given to the last sort no longer apply
+    sort_cols_.clear();
+    unsorted_.clear();
+
     auto const min_w =
         underlying_cast_unsafe<int16_t>(text.extent().width());
 
@@ -706,13 +1127,39 @@ void inventory_list_impl::add_column(
             std::move(text)
           , std::move(get)
           , std::move(sort)
+          , std::move(key)
           , left
           , left + min_w
           , min_w
           , max_w
+          , sizei16x {}
           , id});
 }
 
+void inventory_list_impl::add_column(
+    uint8_t const  id
+  , std::string    label
+  , get_f          get
+  , sort_f         sort
+  , int const      insert_before
+  , sizei16x const width
+) {
+    add_column_(id, std::move(label), std::move(get), std::move(sort), key_f {}
+              , insert_before, width);
+}
+
+void inventory_list_impl::add_column(
+    uint8_t const  id
+  , std::string    label
+  , get_f          get
+  , key_f          key
+  , int const      insert_before
+  , sizei16x const width
+) {
+    add_column_(id, std::move(label), std::move(get), sort_f {}, std::move(key)
+              , insert_before, width);
+}
+
 inventory_list::hit_test_result
 inventory_list_impl::hit_test(point2i32 const p0) const noexcept {
     auto const& m = metrics_;
@@ -768,45 +1215,44 @@ inventory_list_impl::hit_test(point2i32 const p0) const noexcept {
             return p.x >= col.left && p.x < col.right;
         }));
 
-    auto const row_i = static_cast<int32_t>(distance_to_matching_or(sorted_, -1
-        , [&](size_t const r) noexcept {
-            auto const& row = rows_[r];
-            if (row.empty()) {
-                return false;
-            }
-
-            auto const extent = row[0].extent();
-            return p.y >= extent.y0 && p.y < extent.y1;
-        }));
-
     // a hit in the column header
-    if (row_i < 0) {
+    if (value_cast(p.y) < value_cast(metrics_.header_h)) {
         return {type::header, col_i, 0};
     }
 
+    auto const row_h = std::max(1, value_cast(row_height()));
+    auto const row_i = (value_cast(p.y) - value_cast(metrics_.header_h)) / row_h;
+
+    // below the last row
+    if (row_i >= static_cast<int32_t>(rows())) {
+        return {type::empty, 0, 0};
+    }
+
     // a hit in a cell
     return {type::cell, col_i, row_i};
 }
 
 void inventory_list_impl::layout() noexcept {
-    auto const& c = config_;
+    ++version_;
 
-    auto const get_max_col_w = [&](size_t const i) noexcept {
-        auto const header_w = cols_[i].text.extent().width();
+    auto const& c = config_;
 
-        auto const first = begin(rows_);
-        auto const last  = end(rows_);
+    // the widest cell of each column is kept up to date as rows are added
+    // and refreshed; only a shrunk or removed widest cell needs a rescan
+    if (widest_stale_) {
+        widest_stale_ = false;
 
-        if (first == last) {
-            return header_w;
+        for (size_t i = 0; i < cols(); ++i) {
+            cols_[i].widest = sizei16x {};
+            for (auto const& row : rows_) {
+                cols_[i].widest = std::max(cols_[i].widest, row[i].width);
+            }
         }
+    }
 
-        auto const& row = *std::max_element(first, last
-            , [i](row_t const& lhs, row_t const& rhs) noexcept {
-                return lhs[i].extent().width() < rhs[i].extent().width();
-            });
-
-        return std::max(header_w, row[i].extent().width());
+    auto const get_max_col_w = [&](size_t const i) noexcept {
+        auto const header_w = cols_[i].text.extent().width();
+        return std::max(header_w, sizei32x {cols_[i].widest});
     };
 
     int32_t x = 0;
@@ -831,28 +1277,66 @@ void inventory_list_impl::layout() noexcept {
     content_w_ = x;
 
     metrics_.header_h = header_h;
-    int32_t y = header_h;
 
-    // resize cells
-    for (size_t yi = 0; yi < rows(); ++yi) {
-        int32_t max_h = 0;
-        x = 0;
+    // every row is a single line; cells are positioned as they are laid out
+    content_h_ = header_h
+      + static_cast<int32_t>(rows()) * value_cast(row_height());
+}
+
+std::pair<text_layout const*, text_layout const*>
+inventory_list_impl::row(int const index) const noexcept {
+    BK_ASSERT(check_row_(index));
+
+    auto const i = sorted_index_(index);
+    ++row_layout_tick_;
+
+    auto const it = std::find_if(begin(row_layouts_), end(row_layouts_)
+      , [i](row_layout_t const& r) noexcept { return r.row == i; });
+
+    auto& result = [&]() -> row_layout_t& {
+        if (it != end(row_layouts_)) {
+            return *it;
+        }
+
+        auto const& row = rows_[i];
 
-        auto& row = get_row_(yi);
+        // lay out the row anew, recycling the least recently used layout if
+        // there are enough already
+        if (row_layouts_.size() < row_layout_capacity_()) {
+            row_layouts_.push_back({{}, i, 0});
 
-        for (size_t xi = 0; xi < cols(); ++xi) {
-            auto const& col  = cols_[xi];
-            auto&       cell = row[xi];
+            auto& cells = row_layouts_.back().cells;
+            cells.reserve(cols());
 
-            auto const h = cell.extent().height();
-            max_h = std::max(max_h, value_cast(h));
-            cell.move_to(value_cast(col.left), y);
+            for (size_t c = 0; c < cols(); ++c) {
+                cells.emplace_back(trender_, row[c].text, cols_[c].max_width, sizei16y {});
+            }
+
+            return row_layouts_.back();
+        }
+
+        auto& lru = *std::min_element(begin(row_layouts_), end(row_layouts_)
+          , [](row_layout_t const& a, row_layout_t const& b) noexcept {
+                return a.last_used < b.last_used; });
+
+        lru.row = i;
+        for (size_t c = 0; c < cols(); ++c) {
+            lru.cells[c].layout(trender_, row[c].text);
         }
 
-        y += max_h;
+        return lru;
+    }();
+
+    result.last_used = row_layout_tick_;
+
+    // the position depends on the sort order and column layout, both of which
+    // can change without the text changing
+    auto const y = value_cast(cell_rect_(0, static_cast<size_t>(index)).y0);
+    for (size_t c = 0; c < cols(); ++c) {
+        result.cells[c].move_to(value_cast(cols_[c].left), y);
     }
 
-    content_h_ = y;
+    return {result.cells.data(), result.cells.data() + result.cells.size()};
 }
 
 } //namespace boken
@@ -25,6 +25,10 @@ public:
     using sort_f = std::function<int (const_item_descriptor, string_view
                                     , const_item_descriptor, string_view)>;
 
+    //! function used to get an integral sort key for a cell from an item
+    //! instance; rows are then ordered by key.
+    using key_f = std::function<int64_t (const_item_descriptor)>;
+
     //! insert new column of row and the end
     static int const insert_at_end = -1;
 
@@ -83,6 +87,17 @@ public:
     virtual recti32 cell_bounds(int col, int row) const noexcept = 0;
     virtual vec2i32 scroll_offset() const noexcept = 0;
 
+    //! every row is the same height.
+    virtual sizei32y row_height() const noexcept = 0;
+
+    //! @returns the range [first, last) of rows which intersect the client
+    //! area at the current scroll position.
+    virtual std::pair<int, int> visible_rows() const noexcept = 0;
+
+    //! incremented whenever the list changes in a way which affects how it is
+    //! drawn.
+    virtual uint32_t version() const noexcept = 0;
+
     //--------------------------------------------------------------------------
     virtual bool show() noexcept = 0;
     virtual bool hide() noexcept = 0;
@@ -138,11 +153,16 @@ public:
 
     virtual void sort(int const* first, int const* last) noexcept = 0;
 
+    //! Move each row added or refreshed since the last sort to where that sort
+    //! would place it; the other rows are already in order and keep it.
+    virtual void resort() noexcept = 0;
+
     //--------------------------------------------------------------------------
     virtual void reserve(size_t cols, size_t rows) = 0;
 
     //! @note The functor get_f is copied internally; any state must be captured
     //!       by value: be careful of dangling references.
+    //! @note If @p sort is empty, rows are ordered by the text of the cell.
     virtual void add_column(
         uint8_t     id
       , std::string label
@@ -151,12 +171,31 @@ public:
       , int         insert_before = insert_at_end
       , sizei16x    width         = adjust_to_fit) = 0;
 
+    //! As above, but rows are ordered by the key obtained from @p key when the
+    //! row is added. Prefer this to a sort_f where possible; sorting by key
+    //! doesn't require calling back into the game state.
+    virtual void add_column(
+        uint8_t     id
+      , std::string label
+      , get_f       get
+      , key_f       key
+      , int         insert_before = insert_at_end
+      , sizei16x    width         = adjust_to_fit) = 0;
+
     virtual void add_row(item_instance_id id) = 0;
     virtual void add_rows(item_instance_id const* first, item_instance_id const* last) = 0;
 
+    //! Remove the rows at the (sorted) indicies given; the order and selection
+    //! state of the remaining rows are kept.
     virtual void remove_row(int i) noexcept = 0;
     virtual void remove_rows(int const* first, int const* last) noexcept = 0;
 
+    //! Update the cells of each of the rows at the (sorted) indicies given
+    //! whose item has changed since the row was added or last refreshed; no
+    //! other rows are looked at.
+    //! @returns the number of rows updated.
+    virtual int refresh(int const* first, int const* last) = 0;
+
     virtual void clear_rows() noexcept = 0;
     virtual void clear() noexcept = 0;
 
@@ -178,6 +217,11 @@ public:
     virtual column_info col(int index) const noexcept = 0;
 
     //--------------------------------------------------------------------------
+
+    //! The text for each cell of the row at @p index. Rows are only laid out
+    //! when requested, and only a limited number are kept; the result remains
+    //! valid until enough other rows have been requested that it is recycled,
+    //! or until rows or columns are removed.
     virtual std::pair<text_layout const*, text_layout const*>
         row(int index) const noexcept = 0;
 
@@ -72,14 +72,14 @@ bool impl_can_add_item(
     auto const dest_capacity = get_property_value_or(dest, p_capacity, 0);
     if (dest_capacity <= 0) {
         if (subject) {
-            result.append("%s can't put the %s in the %s: the destination is not a container."
-              , name_of_decorated(ctx, *subject).data()
-              , name_of_decorated(ctx, itm).data()
-              , name_of_decorated(ctx, dest).data());
+            result.format("{} can't put the {} in the {}: the destination is not a container."
+              , *subject
+              , itm
+              , dest);
         } else {
-            result.append("the %s be can't put in the %s: the destination is not a container."
-              , name_of_decorated(ctx, itm).data()
-              , name_of_decorated(ctx, dest).data());
+            result.format("the {} be can't put in the {}: the destination is not a container."
+              , itm
+              , dest);
         }
 
         return false;
@@ -87,16 +87,16 @@ bool impl_can_add_item(
 
     auto const itm_capacity = get_property_value_or(itm, p_capacity, 0);
     if (itm_capacity > 0) {
-        result.append("the %s won't fit in the %s: the item is too big."
-          , name_of_decorated(ctx, itm).data()
-          , name_of_decorated(ctx, dest).data());
+        result.format("the {} won't fit in the {}: the item is too big."
+          , itm
+          , dest);
         return false;
     }
 
     if (dest.obj.items().size() + 1 > dest_capacity) {
-        result.append("the %s won't fit in the %s: the destination is full."
-          , name_of_decorated(ctx, itm).data()
-          , name_of_decorated(ctx, dest).data());
+        result.format("the {} won't fit in the {}: the destination is full."
+          , itm
+          , dest);
         return false;
     }
 
@@ -186,6 +186,7 @@ void merge_into_pile(
   , item_descriptor const pile
 ) {
     merge_into_pile(ctx, std::move(itm_ptr), itm, pile.obj.items());
+    pile.obj.items_changed();
 }
 
 //=====--------------------------------------------------------------------=====
@@ -195,38 +196,50 @@ std::string name_of_decorated(
     const_context         const ctx
   , const_item_descriptor const itm
 ) {
+    static_string_buffer<128> buffer;
+    append_name_of_decorated(buffer, itm);
+    return buffer.to_string();
+}
+
+bool append_name_of_decorated(
+    string_buffer_base&         buffer
+  , const_item_descriptor const itm
+) noexcept {
+    if (buffer.is_null()) {
+        return false;
+    }
+
     if (!itm) {
-        return "{missing definition}";
+        return buffer.append("{missing definition}");
     }
 
-    static_string_buffer<128> buffer;
-    buffer.append("%s", itm.def->name.data());
+    if (!buffer.append("%s", itm.def->name.data())) {
+        return false;
+    }
 
     auto const id_status = is_identified(itm);
     auto const capacity  = is_container(itm);
 
-    if (capacity > 0) {
-        if (id_status < 1) {
-            buffer.append(" [?]");
-        } else {
-            auto const& items = itm.obj.items();
-            // count items that don't have a 0 id; this can happen when items
-            // are begin moved from one pile to another due to the way the
-            // move algorithm behaves.
-            auto const n = std::count_if(begin(items), end(items)
-              , [&](item_instance_id const id) {
-                    return id != item_instance_id {};
-                });
-
-            if (n == 0) {
-                buffer.append(" <cr>[empty]</c>");
-            } else {
-                buffer.append(" [%d]", static_cast<int>(n));
-            }
-        }
+    if (capacity <= 0) {
+        return true;
     }
 
-    return buffer.to_string();
+    if (id_status < 1) {
+        return buffer.append(" [?]");
+    }
+
+    auto const& items = itm.obj.items();
+    // count items that don't have a 0 id; this can happen when items
+    // are begin moved from one pile to another due to the way the
+    // move algorithm behaves.
+    auto const n = std::count_if(begin(items), end(items)
+      , [&](item_instance_id const id) noexcept {
+            return id != item_instance_id {};
+        });
+
+    return (n == 0)
+      ? buffer.append(" <cr>[empty]</c>")
+      : buffer.append(" [%d]", static_cast<int>(n));
 }
 
 uint32_t is_identified(const_item_descriptor const itm) noexcept {
@@ -401,6 +414,18 @@ unique_item create_object(
     });
 }
 
+std::vector<unique_item> create_objects(
+    game_database const&   db
+  , world&                 w
+  , item_definition const& def
+  , random_state&          rng
+  , size_t const           n
+) {
+    return create_objects(w, n, [&](item_instance_id const instance) {
+        return create_object(db, w, instance, def, rng);
+    });
+}
+
 //=====--------------------------------------------------------------------=====
 //                                  item
 //=====--------------------------------------------------------------------=====
@@ -41,6 +41,8 @@ bool impl_can_remove_item(
 
 } // namespace detail
 
+//! returns whether the subject can put the item in itm_dest. If not, a
+//! formatted reason is written to result unless it is a null_string_buffer.
 inline bool can_add_item(
     const_context                      const ctx
   , subject_t<const_entity_descriptor> const subject
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <unordered_map>
 
 namespace boken {
 
@@ -41,14 +42,12 @@ public:
     }
 
     void add_column(std::string heading, get_f getter) final override {
-        auto const by_string = [](
-            const_item_descriptor, string_view const lhs
-          , const_item_descriptor, string_view const rhs
-        ) noexcept {
-            return lhs.compare(rhs);
-        };
+        add_column(std::move(heading), std::move(getter), sort_f {});
+    }
 
-        add_column(std::move(heading), std::move(getter), by_string);
+    void add_column(std::string heading, get_f getter, key_f key) final override {
+        auto const id = static_cast<uint8_t>(list_->cols() & 0xFFu);
+        list_->add_column(id, std::move(heading), std::move(getter), std::move(key));
     }
 
     void add_column(
@@ -73,20 +72,18 @@ public:
               , [=](id_t const i) {
                     return std::to_string(weight_of_inclusive(ctx, i));
                 }
-              , [=](id_t const lhs, string_view, id_t const rhs, string_view) {
-                    return compare(weight_of_inclusive(ctx, lhs)
-                                 , weight_of_inclusive(ctx, rhs));
-                });
+              , key_f {[=](id_t const i) {
+                    return int64_t {weight_of_inclusive(ctx, i)};
+                }});
             break;
         case column_type::count:
             add_column("Count"
               , [=](id_t const i) {
                     return std::to_string(current_stack_size(i));
                 }
-              , [=](id_t const lhs, string_view, id_t const rhs, string_view) {
-                    return compare(current_stack_size(lhs)
-                                 , current_stack_size(rhs));
-                });
+              , key_f {[=](id_t const i) {
+                    return int64_t {current_stack_size(i)};
+                }});
             break;
         default:
             BK_ASSERT(false);
@@ -361,6 +358,63 @@ public:
         return static_cast<int>(il.rows());
     }
 
+    int update(item_pile const& items) final override {
+        auto& il = *list_;
+
+        auto const n = static_cast<int>(il.rows());
+
+        // the row of each item currently listed
+        listed_rows_.clear();
+        for (int i = 0; i < n; ++i) {
+            listed_rows_.emplace(value_cast(il.row_data(i)), i);
+        }
+
+        // what remains in listed_rows_ is no longer wanted
+        kept_rows_.clear();
+        added_ids_.clear();
+        for (auto const id : items) {
+            auto const it = listed_rows_.find(value_cast(id));
+            if (it == end(listed_rows_)) {
+                added_ids_.push_back(id);
+                continue;
+            }
+
+            kept_rows_.push_back(it->second);
+            listed_rows_.erase(it);
+        }
+
+        removed_rows_.clear();
+        for (auto const& p : listed_rows_) {
+            removed_rows_.push_back(p.second);
+        }
+
+        // only the rows still listed can have changed; this must come before
+        // their indices are invalidated by remove_rows
+        auto const changed = kept_rows_.empty() ? 0
+          : il.refresh(kept_rows_.data(), kept_rows_.data() + kept_rows_.size());
+
+        if (!removed_rows_.empty()) {
+            il.remove_rows(removed_rows_.data()
+                         , removed_rows_.data() + removed_rows_.size());
+        }
+
+        if (!added_ids_.empty()) {
+            il.add_rows(added_ids_.data(), added_ids_.data() + added_ids_.size());
+        }
+
+        auto const is_changed = changed
+                             || !removed_rows_.empty()
+                             || !added_ids_.empty();
+
+        // only the added and changed rows are put back in order
+        if (is_changed) {
+            il.resort();
+            il.layout();
+        }
+
+        return static_cast<int>(il.rows());
+    }
+
     void append(std::initializer_list<item_instance_id> const list) final override {
         list_->add_rows(begin(list), end(list));
     }
@@ -608,6 +662,12 @@ private:
     // The current set of columns to sort by.
     std::vector<int> sort_cols_;
 
+    // Temporary buffers used by update.
+    std::unordered_map<uint32_t, int> listed_rows_; //!< by item id
+    std::vector<item_instance_id>     added_ids_;
+    std::vector<int>                  kept_rows_;
+    std::vector<int>                  removed_rows_;
+
     bool is_moving_       {false};
     bool is_sizing_       {false};
     bool is_modal_        {false};
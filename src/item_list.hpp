@@ -47,6 +47,7 @@ public:
     using on_selection_change_t = std::function<void (int)>;
     using get_f                 = inventory_list::get_f;
     using sort_f                = inventory_list::sort_f;
+    using key_f                 = inventory_list::key_f;
 
     enum class column_type {
         icon, name, weight, count
@@ -73,6 +74,9 @@ public:
     //! use a string based sort
     virtual void add_column(std::string heading, get_f getter) = 0;
 
+    //! use a sort based on an integral key for each item
+    virtual void add_column(std::string heading, get_f getter, key_f key) = 0;
+
     //! add a standard column
     virtual void add_column(const_context ctx, column_type type) = 0;
 
@@ -113,6 +117,13 @@ public:
     //! items, and adjusts the layout to fit said items.
     virtual int assign(item_pile const& items) = 0;
 
+    //! Update the list to match items by adding rows for items not already
+    //! present, removing rows for items no longer present, and updating the
+    //! rows of items which have changed. The order of existing rows and the
+    //! selection are kept.
+    //! @returns the number of rows.
+    virtual int update(item_pile const& items) = 0;
+
     virtual void append(std::initializer_list<item_instance_id> list) = 0;
     virtual void append(item_instance_id id) = 0;
 
@@ -13,6 +13,7 @@
 #include "graph.hpp"
 #include "format.hpp"
 #include "names.hpp"
+#include "memory_stats.hpp"
 
 #include <bkassert/assert.hpp>  // for BK_ASSERT
 
@@ -36,9 +37,9 @@ bool impl_can_add_item(
   , string_buffer_base&           result
 ) noexcept {
     if (itm_dest.lvl.can_place_item_at(itm_dest.p) != placement_result::ok) {
-        result.append("%s can't put the %s there."
-          , name_of_decorated(ctx, subject).data()
-          , name_of_decorated(ctx, itm).data());
+        result.format("{} can't put the {} there."
+          , subject
+          , itm);
         return false;
     }
 
@@ -201,10 +202,10 @@ struct level_data_t {
     {
     }
 
-    std::vector<tile_id>    ids;
-    std::vector<tile_type>  types;
-    std::vector<tile_flags> flags;
-    std::vector<region_id>  region_ids;
+    tracked_vector<tile_id,    memory_tag::level> ids;
+    tracked_vector<tile_type,  memory_tag::level> types;
+    tracked_vector<tile_flags, memory_tag::level> flags;
+    tracked_vector<region_id,  memory_tag::level> region_ids;
 };
 
 class level_impl;
@@ -262,6 +263,10 @@ public:
         return id_;
     }
 
+    uint32_t version() const noexcept final override {
+        return version_;
+    }
+
     maybe<point2i32> find(entity_instance_id const id) const noexcept final override {
         auto const result = entities_.find(id);
         if (!result.first) {
@@ -313,6 +318,10 @@ public:
             return std::make_pair(q, result == placement_result::ok);
         });
 
+        if (result == placement_result::ok) {
+            ++version_;
+        }
+
         return result;
     }
 
@@ -362,6 +371,8 @@ public:
             pile->add_item(std::move(i));
         }
 
+        ++version_;
+
         return result;
     }
 
@@ -379,19 +390,24 @@ public:
         auto const insert_result = entities_.insert(q, e.release());
         BK_ASSERT(insert_result.second);
 
+        ++version_;
+
         return result;
     }
 
     unique_entity remove_entity_at(point2i32 const p) noexcept final override {
         BK_ASSERT(!!entity_deleter_);
         auto const result = entities_.erase(underlying_cast_unsafe<int16_t>(p));
+        version_ += result.second ? 1u : 0u;
         return result.second
           ? unique_entity {result.first, *entity_deleter_}
           : unique_entity {entity_instance_id {}, *entity_deleter_};
     }
 
     unique_entity remove_entity(entity_instance_id const id) noexcept final override {
-        return entities_.erase(id).second
+        auto const erased = entities_.erase(id).second;
+        version_ += erased ? 1u : 0u;
+        return erased
           ? unique_entity {id, *entity_deleter_}
           : unique_entity {entity_instance_id {}, *entity_deleter_};
     }
@@ -504,7 +520,7 @@ public:
         point2i32 const from
       , int const* const first
       , int const* const last
-      , std::function<void (unique_item&&, int)> const& pred
+      , function_ref<void (unique_item&&, int)> pred
     ) {
         BK_ASSERT(( !first &&  !last)
                || (!!first && !!last));
@@ -524,6 +540,8 @@ public:
           ? src_pile->remove_if(pred)
           : src_pile->remove_if(first, last, trans, pred);
 
+        version_ += (n > 0) ? 1u : 0u;
+
         if (src_pile->empty()) {
             items_.erase(src_pos);
             return {merge_item_result::ok_merged_all, n};
@@ -536,7 +554,7 @@ public:
 
     std::pair<merge_item_result, int> move_items(
         point2i32 const from
-      , std::function<void (unique_item&&, int)> const& pred
+      , function_ref<void (unique_item&&, int)> pred
     ) final override {
         return impl_move_items_(from, nullptr, nullptr, pred);
     }
@@ -545,7 +563,7 @@ public:
         point2i32 const from
       , int const* const first
       , int const* const last
-      , std::function<void (unique_item&&, int)> const& pred
+      , function_ref<void (unique_item&&, int)> pred
     ) final override {
         return impl_move_items_(from, first, last, pred);
     }
@@ -579,7 +597,7 @@ public:
 
     unique_entity with_entity_at(
         point2i32 const p
-      , std::function<bool (entity_instance_id)> const& f
+      , function_ref<bool (entity_instance_id)> f
     ) final override {
         auto const p0 = underlying_cast_unsafe<int16_t>(p);
         auto const id_ptr = entities_.find(p0);
@@ -614,26 +632,26 @@ public:
         }
     }
 
-    void for_each_pile(std::function<void (item_pile const&, point2i32)> const& f) const final override {
+    void for_each_pile(function_ref<void (item_pile const&, point2i32)> f) const final override {
         for_each_object_impl_(items_, f);
     }
 
-    void for_each_pile_while(std::function<bool (item_pile const&, point2i32)> const& f) const final override {
+    void for_each_pile_while(function_ref<bool (item_pile const&, point2i32)> f) const final override {
         for_each_object_impl_(items_, f);
     }
 
-    void for_each_entity(std::function<void (entity_instance_id, point2i32)> const& f) const final override {
+    void for_each_entity(function_ref<void (entity_instance_id, point2i32)> f) const final override {
         for_each_object_impl_(entities_, f);
     }
 
-    void for_each_entity_while(std::function<bool (entity_instance_id, point2i32)> const& f) const final override {
+    void for_each_entity_while(function_ref<bool (entity_instance_id, point2i32)> f) const final override {
         for_each_object_impl_(entities_, f);
     }
 
     void for_each_entity_near_while(
         point2i32 const p
       , int32_t const distance
-      , std::function<bool (entity_position)> const& f
+      , function_ref<bool (entity_position)> f
     ) const final override {
         for_each_entity_near_impl_(p, distance, f);
     }
@@ -641,7 +659,7 @@ public:
     void for_each_entity_near(
         point2i32 const p
       , int32_t const distance
-      , std::function<void (entity_position)> const& f
+      , function_ref<void (entity_position)> f
     ) const final override {
         for_each_entity_near_impl_(p, distance, f);
     }
@@ -700,10 +718,10 @@ public:
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // implementation
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-    template <typename T>
+    template <typename T, typename Allocator>
     void copy_region(tile_data_set const* src
                    , T const tile_data_set::* src_field, recti32 src_rect
-                   , std::vector<T>& dst) noexcept;
+                   , std::vector<T, Allocator>& dst) noexcept;
 
     void place_doors(random_state& rng, recti32 area);
 
@@ -803,6 +821,8 @@ private:
     world& world_;
     size_t id_;
 
+    uint32_t version_ {0};
+
     // logically const, but keeps a mutable buffer internally used across
     // invocations
     a_star_pather<level_adapter> mutable pather_;
@@ -1243,7 +1263,7 @@ void level_impl::generate_make_connections(random_state& rng) {
     auto const region_count = regions_.size();
 
     using vertex_t     = int16_t;
-    using graph_data_t = int8_t;
+    using graph_data_t = int16_t;
 
     auto graph      = adjacency_matrix<vertex_t> {static_cast<int>(region_count)};
     auto graph_data = vertex_data<graph_data_t>  {static_cast<int>(region_count)};
@@ -1459,6 +1479,8 @@ level_impl::update_tile_rect(
   , recti32              const area
   , tile_data_set const* const data
 ) {
+    ++version_;
+
     copy_region(data, &tile_data_set::id,    area, data_.ids);
     copy_region(data, &tile_data_set::type,  area, data_.types);
     copy_region(data, &tile_data_set::flags, area, data_.flags);
@@ -1487,12 +1509,12 @@ level_impl::update_tile_at(
     return update_tile_rect(rng, r, &data);
 }
 
-template <typename T>
+template <typename T, typename Allocator>
 void level_impl::copy_region(
     tile_data_set const*     const src
   , T const tile_data_set::* const src_field
   , recti32 const                  src_rect
-  , std::vector<T>&                dst
+  , std::vector<T, Allocator>&     dst
 ) noexcept {
     auto const src_w = value_cast_unsafe<size_t>(src_rect.width());
     auto const dst_w = value_cast_unsafe<size_t>(width());
@@ -5,12 +5,12 @@
 #include "utility.hpp"
 #include "context.hpp"
 #include "maybe.hpp"
+#include "functional.hpp"
 
 #include <memory>
 #include <utility>
 #include <vector>
 #include <array>
-#include <functional>
 
 #include <cstdint>
 #include <cstddef>
@@ -83,6 +83,11 @@ public:
     //! The identifier for the level.
     virtual size_t id() const noexcept = 0;
 
+    //! Incremented whenever a tile changes, or an entity or item is added to,
+    //! removed from, or moved on the level. Changes to the objects themselves
+    //! are tracked by the objects.
+    virtual uint32_t version() const noexcept = 0;
+
     //! Return a valid position if an entity with @p id exists on the level.
     virtual maybe<point2i32> find(entity_instance_id id) const noexcept = 0;
 
@@ -137,19 +142,19 @@ public:
     //! If @p f returns false, the entity is destroyed before control returns to
     //! the caller.
     virtual unique_entity with_entity_at(
-        point2i32 p, std::function<bool (entity_instance_id)> const& f) = 0;
+        point2i32 p, function_ref<bool (entity_instance_id)> f) = 0;
 
     virtual void for_each_pile(
-        std::function<void (item_pile const&, point2i32)> const& f) const = 0;
+        function_ref<void (item_pile const&, point2i32)> f) const = 0;
 
     virtual void for_each_pile_while(
-        std::function<bool (item_pile const&, point2i32)> const& f) const = 0;
+        function_ref<bool (item_pile const&, point2i32)> f) const = 0;
 
     virtual void for_each_entity(
-        std::function<void (entity_instance_id, point2i32)> const& f) const = 0;
+        function_ref<void (entity_instance_id, point2i32)> f) const = 0;
 
     virtual void for_each_entity_while(
-        std::function<bool (entity_instance_id, point2i32)> const& f) const = 0;
+        function_ref<bool (entity_instance_id, point2i32)> f) const = 0;
 
     //! The vector will have its contents cleared and will then be filled with a
     //! path from @p from to @p to.
@@ -171,18 +176,18 @@ public:
         entities_near(point2i32 p, int32_t distance) const = 0;
 
     virtual void for_each_entity_near_while(point2i32 p, int32_t distance
-        , std::function<bool (entity_position)> const& f) const = 0;
+        , function_ref<bool (entity_position)> f) const = 0;
 
     virtual void for_each_entity_near(point2i32 p, int32_t distance
-        , std::function<void (entity_position)> const& f) const = 0;
+        , function_ref<void (entity_position)> f) const = 0;
 
     //===--------------------------------------------------------------------===
     //                          State Mutation
     //===--------------------------------------------------------------------===
-    using transform_f = std::function<
+    using transform_f = function_ref<
         std::pair<entity_descriptor, point2i32> (entity_instance_id, point2i32)>;
 
-    using transform_callback_f = std::function<
+    using transform_callback_f = function_ref<
         void (entity_descriptor, placement_result, point2i32, point2i32)>;
 
     virtual void transform_entities(
@@ -237,14 +242,14 @@ public:
     virtual std::pair<merge_item_result, int>
     move_items(
         point2i32 from
-      , std::function<void (unique_item&&, int)> const& pred) = 0;
+      , function_ref<void (unique_item&&, int)> pred) = 0;
 
     virtual std::pair<merge_item_result, int>
     move_items(
         point2i32  from
       , int const* first
       , int const* last
-      , std::function<void (unique_item&&, int)> const& pred) = 0;
+      , function_ref<void (unique_item&&, int)> pred) = 0;
 
     //===--------------------------------------------------------------------===
     //                         Block-based data access
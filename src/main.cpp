@@ -14,6 +14,7 @@
 #include "item_properties.hpp"
 #include "level.hpp"        // for level, placement_result, make_level, etc
 #include "math.hpp"         // for vec2i32, floor_as, point2f, basic_2_tuple, etc
+#include "memory_stats.hpp" // for memory_stats, write_memory_stats
 #include "message_log.hpp"  // for message_log
 #include "names.hpp"
 #include "random.hpp"       // for random_state, make_random_state
@@ -33,6 +34,7 @@
 #include <chrono>           // for microseconds, operator-, duration, etc
 #include <deque>
 #include <functional>       // for function
+#include <future>           // for async
 #include <memory>           // for unique_ptr, allocator
 #include <ratio>            // for ratio
 #include <string>           // for string, to_string
@@ -225,17 +227,21 @@ struct game_state {
     //! Show the toolip for the 'view' command
     //! @param p Position in world coordinates
     void show_view_tool_tip(point2i32 const p) {
+        if (!update_tool_tip_key(p, false)) {
+            return; // nothing shown has changed; keep the current layout
+        }
+
         auto const& lvl  = the_world.current_level();
         auto const& tile = lvl.at(p);
 
         static_string_buffer<256> buffer;
 
         auto const print_entity_info = [&](const_entity_descriptor const e) {
-            return buffer.append("%s", name_of_decorated(ctx, e).data());
+            return append_name_of_decorated(buffer, e);
         };
 
         auto const print_item_info = [&](const_item_descriptor const i) {
-            return buffer.append("%s", name_of_decorated(ctx, i).data());
+            return append_name_of_decorated(buffer, i);
         };
 
         auto const print_entity = [&]() noexcept {
@@ -253,24 +259,23 @@ struct game_state {
             auto const& pile = *ptr;
             auto i = pile.size();
 
-            buffer.append("\n");
+            buffer.write('\n');
 
             for (auto const& id : pile) {
                 if (!print_item_info({ctx, id})) {
                     return false;
                 }
 
-                if ((i && --i) && !buffer.append(", ")) {
+                if ((i && --i) && !buffer.write(", ")) {
                     return false;
                 }
             }
 
-            return buffer.append("\n");
+            return buffer.write('\n');
         };
 
         auto const result =
-            buffer.append("You see here: %s\n"
-              , enum_to_string(lvl.at(p).id).data())
+            buffer.format("You see here: {}\n", enum_to_string(lvl.at(p).id))
          && print_entity()
          && print_items();
 
@@ -280,13 +285,12 @@ struct game_state {
     //! @param p Position in window coordinates
     void debug_show_tool_tip(point2i32 const p) {
         auto const p0 = window_to_world(p);
-        auto const q  = window_to_world({last_mouse_x, last_mouse_y});
 
-        auto const was_visible = tool_tip.visible(true);
+        tool_tip.visible(true);
         tool_tip.set_position(p);
 
-        if (was_visible && p0 == q) {
-            return; // the tile the mouse points to is unchanged from last time
+        if (!update_tool_tip_key(p0, true)) {
+            return; // nothing shown has changed; keep the current layout
         }
 
         auto const& lvl  = current_level();
@@ -295,24 +299,24 @@ struct game_state {
         static_string_buffer<512> buffer;
 
         auto const print_entity_info = [&](const_entity_descriptor const e) {
-            return buffer.append(
+            return buffer.format(
                 "Entity:\n"
-                " Instance  : %0#10x\n"
-                " Definition: %0#10x (%s)\n"
-                " Name      : %s\n"
-              , value_cast(get_instance(e))
-              , value_cast(get_id(e)), id_string(e).data()
-              , name_of(ctx, e).data());
+                " Instance  : {}\n"
+                " Definition: {} ({})\n"
+                " Name      : {}\n"
+              , hex(value_cast(get_instance(e)), 8)
+              , hex(value_cast(get_id(e)), 8), id_string(e)
+              , name_of(ctx, e));
         };
 
         auto const print_item_info = [&](const_item_descriptor const i) {
-            return buffer.append(
-                " Instance  : %0#10x\n"
-                " Definition: %0#10x (%s)\n"
-                " Name      : %s\n"
-              , value_cast(get_instance(i))
-              , value_cast(get_id(i)), id_string(i).data()
-              , name_of(ctx, i).data());
+            return buffer.format(
+                " Instance  : {}\n"
+                " Definition: {} ({})\n"
+                " Name      : {}\n"
+              , hex(value_cast(get_instance(i)), 8)
+              , hex(value_cast(get_id(i)), 8), id_string(i)
+              , name_of(ctx, i));
         };
 
         auto const print_entity = [&] {
@@ -329,8 +333,7 @@ struct game_state {
 
             auto const& pile = *ptr;
 
-            buffer.append("Items (%d):\n"
-              , static_cast<int>(pile.size()));
+            buffer.format("Items ({}):\n", pile.size());
 
             for (auto const& id : pile) {
                 if (!print_item_info({ctx, id})) {
@@ -344,13 +347,13 @@ struct game_state {
         auto const has_los = lvl.has_line_of_sight(player_location(), p0);
 
         auto const result =
-            buffer.append(
-                "Position: %d, %d (%s)\n"
-                "Region  : %d\n"
-                "Tile    : %s\n"
+            buffer.format(
+                "Position: {}, {} ({})\n"
+                "Region  : {}\n"
+                "Tile    : {}\n"
               , value_cast(p0.x), value_cast(p0.y), (has_los ? "seen" : "unseen")
               , value_cast<int>(tile.rid)
-              , enum_to_string(lvl.at(p0).id).data())
+              , enum_to_string(lvl.at(p0).id))
          && print_entity()
          && print_items();
 
@@ -384,6 +387,10 @@ struct game_state {
         BK_ASSERT(!!def_ptr);
         auto const& def = *def_ptr;
 
+        // first find a placement for each entity, then create them all at once
+        std::vector<point2i32> positions;
+        positions.reserve(lvl.region_count());
+
         for (size_t i = 0; i < lvl.region_count(); ++i) {
             auto const& region = lvl.region(i);
             if (region.tile_count <= 0) {
@@ -397,9 +404,20 @@ struct game_state {
                 continue;
             }
 
+            // placements are only checked against entities already on the
+            // level; don't place two new entities on the same tile
             auto const p = result.first;
+            if (std::find(begin(positions), end(positions), p) != end(positions)) {
+                continue;
+            }
+
+            positions.push_back(p);
+        }
 
-            auto instance_id = create_object_at(def, {lvl, p}, rng);
+        auto entities = create_objects(def, rng, positions.size());
+
+        for (size_t i = 0; i < positions.size(); ++i) {
+            auto const instance_id = lvl.add_object_at(std::move(entities[i]), positions[i]);
             auto& new_entity = find(the_world, instance_id);
 
             auto const id = random_weighted(rng, w);
@@ -430,6 +448,9 @@ struct game_state {
         auto const& container_def = *find(database, container_def_id);
         auto const& dagger_def    = *find(database, dagger_def_id);
 
+        std::vector<point2i32> positions;
+        positions.reserve(lvl.region_count());
+
         for (size_t i = 0; i < lvl.region_count(); ++i) {
             auto const& region = lvl.region(i);
             if (region.tile_count <= 0) {
@@ -443,10 +464,20 @@ struct game_state {
                 continue;
             }
 
-            auto const p = result.first;
+            positions.push_back(result.first);
+        }
 
-            auto const container_id = create_object_at(container_def, {lvl, p}, rng);
-            create_object(dagger_def, container_id, rng);
+        auto containers = create_objects(container_def, rng, positions.size());
+        auto daggers    = create_objects(dagger_def,    rng, positions.size());
+
+        for (size_t i = 0; i < positions.size(); ++i) {
+            auto const p = positions[i];
+
+            auto const container_id = lvl.add_object_at(std::move(containers[i]), p);
+
+            auto const itm = item_descriptor {ctx, daggers[i].get()};
+            auto const dst = item_descriptor {ctx, container_id};
+            merge_into_pile(ctx, std::move(daggers[i]), itm, dst);
 
             renderer_update_pile(p);
         }
@@ -536,9 +567,21 @@ struct game_state {
         os.on_resize([&](int32_t const w, int32_t const h) {
             auto const r = message_window.bounds();
             message_window.resize_to({r.top_left(), sizei32x {w}, r.height()});
+            renderer.invalidate();
+        });
+
+        os.on_expose([&] {
+            renderer.invalidate();
+        });
+
+        os.on_render_reset([&] {
+            r_map.reset_render_targets();
+            trender.recopy_atlas();
+            renderer.invalidate();
         });
 
         os.on_key([&](kb_event const event, kb_modifiers const kmods) {
+            flush_mouse_move();
             process_event(&game_state::ui_on_key
                         , &input_context::on_key
                         , &game_state::on_key
@@ -547,6 +590,7 @@ struct game_state {
         });
 
         os.on_text_input([&](text_input_event const event) {
+            flush_mouse_move();
             process_event(&game_state::ui_on_text_input
                         , &input_context::on_text_input
                         , &game_state::on_text_input
@@ -554,17 +598,32 @@ struct game_state {
             cmd_translator.translate(event);
         });
 
+        // motion is handled at most once per iteration of the main loop; a
+        // sweep across the window otherwise rebuilds the tool tip, and
+        // anything else under the mouse, once per event.
         os.on_mouse_move([&](mouse_event const event, kb_modifiers const kmods) {
-            process_event(&game_state::ui_on_mouse_move
-                        , &input_context::on_mouse_move
-                        , &game_state::on_mouse_move
-                        , event, kmods);
+            if (has_pending_mouse_move
+             && (event.button_state != pending_mouse_move.button_state
+              || !(kmods == pending_mouse_kmods))) {
+                flush_mouse_move();
+            }
+
+            if (!has_pending_mouse_move) {
+                pending_mouse_move     = event;
+                pending_mouse_kmods    = kmods;
+                has_pending_mouse_move = true;
+                return;
+            }
 
-            last_mouse_x = event.x;
-            last_mouse_y = event.y;
+            auto& e = pending_mouse_move;
+            e.x   = event.x;
+            e.y   = event.y;
+            e.dx += event.dx;
+            e.dy += event.dy;
         });
 
         os.on_mouse_button([&](mouse_event const event, kb_modifiers const kmods) {
+            flush_mouse_move();
             process_event(&game_state::ui_on_mouse_button
                         , &input_context::on_mouse_button
                         , &game_state::on_mouse_button
@@ -572,6 +631,7 @@ struct game_state {
         });
 
         os.on_mouse_wheel([&](int const wx, int const wy, kb_modifiers const kmods) {
+            flush_mouse_move();
             process_event(&game_state::ui_on_mouse_wheel
                         , &input_context::on_mouse_wheel
                         , &game_state::on_mouse_wheel
@@ -579,6 +639,7 @@ struct game_state {
         });
 
         cmd_translator.on_command([&](command_type const type, uint64_t const data) {
+            flush_mouse_move();
             process_event(&game_state::ui_on_command
                         , &input_context::on_command
                         , &game_state::on_command
@@ -586,6 +647,58 @@ struct game_state {
         });
     }
 
+    //! Make the key for the tool tip shown for the tile at @p p current.
+    //! @returns true if it differs from the key for the text currently shown,
+    //! and the text must be rebuilt; false otherwise.
+    bool update_tool_tip_key(point2i32 const p, bool const debug) noexcept {
+        auto const& lvl = current_level();
+
+        // objects can only appear on, or leave, the tile by way of the level,
+        // and the version of an object only ever increases; so while the
+        // level is unchanged, the sum of the versions changes if and only if
+        // one of the objects does.
+        auto objects_version = result_of_or(lvl.entity_at(p), uint32_t {0}
+          , [&](entity_instance_id const id) noexcept {
+                return const_entity_descriptor {ctx, id}.obj.version(); });
+
+        if (auto const pile = lvl.item_at(p)) {
+            for (auto const& id : *pile) {
+                objects_version += const_item_descriptor {ctx, id}.obj.version();
+            }
+        }
+
+        auto const key = tool_tip_key_t {
+            p, lvl.id(), lvl.version(), objects_version, debug};
+
+        if (key == tool_tip_key) {
+            return false;
+        }
+
+        tool_tip_key = key;
+        return true;
+    }
+
+    //! Handle the mouse motion received since this was last called, combined
+    //! into a single event.
+    void flush_mouse_move() {
+        if (!has_pending_mouse_move) {
+            return;
+        }
+
+        has_pending_mouse_move = false;
+
+        auto const event = pending_mouse_move;
+        auto const kmods = pending_mouse_kmods;
+
+        process_event(&game_state::ui_on_mouse_move
+                    , &input_context::on_mouse_move
+                    , &game_state::on_mouse_move
+                    , event, kmods);
+
+        last_mouse_x = event.x;
+        last_mouse_y = event.y;
+    }
+
     bool ui_on_key(kb_event const event, kb_modifiers const kmods) {
         return item_list.on_key(event, kmods)
             && equip_list.on_key(event, kmods);
@@ -616,7 +729,17 @@ struct game_state {
 
     bool ui_on_mouse_wheel(int const wy, int const wx, kb_modifiers const kmods) {
         return item_list.on_mouse_wheel(wy, wx, kmods)
-            && equip_list.on_mouse_wheel(wy, wx, kmods);
+            && equip_list.on_mouse_wheel(wy, wx, kmods)
+            && [&] {
+                auto const p = point2i32 {last_mouse_x, last_mouse_y};
+                if (!wy || !intersects(message_window.bounds(), p)) {
+                    return true;
+                }
+
+                message_window.scroll_by_messages(wy);
+                r_message_log.show();
+                return false;
+            }();
     }
 
     bool ui_on_command(command_type const type, uintptr_t const data) {
@@ -684,8 +807,8 @@ struct game_state {
         case 0b0100 :
             if (kmods.none()) {
                 update_view_trans(
-                    current_view.x_off + static_cast<float>(event.dx)
-                  , current_view.y_off + static_cast<float>(event.dy));
+                    current_view.x_off() + static_cast<float>(event.dx)
+                  , current_view.y_off() + static_cast<float>(event.dy));
             }
             break;
         case 0b1000 : break;
@@ -698,14 +821,14 @@ struct game_state {
         auto const p_window = point2i32 {last_mouse_x, last_mouse_y};
         auto const p_world  = current_view.window_to_world(p_window);
 
-        auto const scale = current_view.scale_x * (wy > 0 ? 1.1f : 0.9f);
+        auto const scale = current_view.scale_x() * (wy > 0 ? 1.1f : 0.9f);
         update_view_scale(scale, scale);
 
         auto const p_window_new = current_view.world_to_window(p_world);
 
-        auto const dx = current_view.x_off
+        auto const dx = current_view.x_off()
             + value_cast_unsafe<float>(p_window.x) - value_cast(p_window_new.x);
-        auto const dy = current_view.y_off
+        auto const dy = current_view.y_off()
             + value_cast_unsafe<float>(p_window.y) - value_cast(p_window_new.y);
 
         update_view_trans(dx, dy);
@@ -755,6 +878,8 @@ struct game_state {
             r_map.update_map_data();
             break;
         case ct::debug_teleport_self : do_debug_teleport_self(); break;
+        case ct::debug_memory_stats  : do_debug_memory_stats(); break;
+        case ct::debug_profiler      : do_debug_profiler(); break;
 
         case ct::cancel    : do_cancel(); break;
         case ct::confirm   : break;
@@ -967,15 +1092,31 @@ struct game_state {
     void insert_into_container(item_descriptor const container) {
         auto const player = player_descriptor();
 
-        auto const fill_list = [=, cid = container.obj.instance()] {
-            return item_list.assign_if_not(items(player), cid) > 0;
+        // only the items that would actually fit; why the others wouldn't isn't
+        // shown, so no reason is built for them.
+        auto const fill_list = [=] {
+            return item_list.assign_if(items(player), [&](item_instance_id const id) {
+                null_string_buffer none;
+                return can_add_item(ctx
+                  , p_subject(player)
+                  , p_object(item_descriptor {ctx, id})
+                  , p_to(container)
+                  , none);
+            }) > 0;
         };
 
-        if (!items(player) || !fill_list()) {
+        if (!items(player)) {
             println("You have nothing to insert.");
             return;
         }
 
+        if (!fill_list()) {
+            static_string_buffer<128> buffer;
+            buffer.format("Nothing you have will fit in the {}.", container);
+            println(buffer);
+            return;
+        }
+
         using ct = command_type;
         auto const handler = [=](command_type const cmd) {
             if (cmd == ct::cancel && item_list.get().selection_clear() <= 0) {
@@ -1018,10 +1159,10 @@ struct game_state {
       , const_item_descriptor   const itm
       , const_item_descriptor   const container
     ) {
-        buffer.append("%s insert the %s into the %s."
-          , name_of_decorated(ctx, subject).data()
-          , name_of_decorated(ctx, itm).data()
-          , name_of_decorated(ctx, container).data());
+        buffer.format("{} insert the {} into the {}."
+          , subject
+          , itm
+          , container);
     }
 
     void message_drop_item(
@@ -1030,9 +1171,9 @@ struct game_state {
       , const_entity_descriptor const from
       , const_item_descriptor   const itm
     ) {
-        buffer.append("%s drop the %s."
-          , name_of_decorated(ctx, subject).data()
-          , name_of_decorated(ctx, itm).data());
+        buffer.format("{} drop the {}."
+          , subject
+          , itm);
     }
 
     void message_drop_item(
@@ -1041,10 +1182,10 @@ struct game_state {
       , const_item_descriptor   const from
       , const_item_descriptor   const itm
     ) {
-        buffer.append("%s remove the %s from the %s and drop it."
-          , name_of_decorated(ctx, subject).data()
-          , name_of_decorated(ctx, itm).data()
-          , name_of_decorated(ctx, from).data());
+        buffer.format("{} remove the {} from the {} and drop it."
+          , subject
+          , itm
+          , from);
     }
 
     void message_get_item(
@@ -1053,9 +1194,9 @@ struct game_state {
       , const_level_location    const from
       , const_item_descriptor   const itm
     ) {
-        buffer.append("%s pick up the %s."
-          , name_of_decorated(ctx, subject).data()
-          , name_of_decorated(ctx, itm).data());
+        buffer.format("{} pick up the {}."
+          , subject
+          , itm);
     }
 
     void message_get_item(
@@ -1064,10 +1205,10 @@ struct game_state {
       , const_item_descriptor   const from
       , const_item_descriptor   const itm
     ) {
-        buffer.append("%s remove the %s from the %s."
-          , name_of_decorated(ctx, subject).data()
-          , name_of_decorated(ctx, itm).data()
-          , name_of_decorated(ctx, from).data());
+        buffer.format("{} remove the {} from the {}."
+          , subject
+          , itm
+          , from);
     }
 
     template <typename To>
@@ -1159,8 +1300,8 @@ struct game_state {
 
         {
             static_string_buffer<128> buffer;
-            buffer.append("You open the %s."
-                , name_of_decorated(ctx, container).data());
+            buffer.format("You open the {}."
+                , container);
             println(buffer);
         }
 
@@ -1255,7 +1396,7 @@ struct game_state {
                       : (bottom < limit.y) ? value_cast(bottom - limit.y)
                       : 0.0f;
 
-        update_view_trans(current_view.x_off + dx, current_view.y_off + dy);
+        update_view_trans(current_view.x_off() + dx, current_view.y_off() + dy);
     }
 
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1271,9 +1412,15 @@ struct game_state {
 
     template <typename Obj, typename FwdIt, typename Predicate>
     int impl_move_items(Obj const obj, FwdIt const first, FwdIt const last, Predicate pred, int) {
-        return obj->items().remove_if(first, last
+        auto const n = obj->items().remove_if(first, last
           , [&](int const i) noexcept { return item_list.get().row_data(i); }
           , pred);
+
+        if (n > 0) {
+            obj->items_changed();
+        }
+
+        return n;
     }
 
     template <typename FwdIt, typename Predicate>
@@ -1544,10 +1691,8 @@ struct game_state {
         equip_list.get().indicate(i);
     }
 
-    //! Update the item list window
-    //! TODO: currently this just repopulates the window from scratch each time
-    //!       this could be implemented more intelligently to only add / remove
-    //!       what is actually required.
+    //! Update the item list window; only the rows for items which have been
+    //! added, removed, or changed are touched.
     void update_item_list(const_entity_descriptor const e, int indicated = -1) {
         if (!item_list.is_visible()) {
             return;
@@ -1557,7 +1702,7 @@ struct game_state {
             indicated = item_list.get().indicated();
         }
 
-        item_list.assign(e->items());
+        item_list.update(e->items());
         item_list.get().indicate(indicated);
     }
 
@@ -1776,8 +1921,8 @@ struct game_state {
             auto const container = item_descriptor {ctx, *first};
 
             static_string_buffer<128> buffer;
-            buffer.append("Open the %s in your inventory? y/n"
-              , name_of_decorated(ctx, container).data());
+            buffer.format("Open the {} in your inventory? y/n"
+              , container);
             println(buffer);
 
             query_yes_no([=](command_type const cmd) {
@@ -1799,6 +1944,50 @@ struct game_state {
         }
     }
 
+    void do_debug_memory_stats() {
+        if (!memory_stats_enabled()) {
+            println("Memory statistics are disabled (BK_MEMORY_STATS).");
+            return;
+        }
+
+        static_string_buffer<128> buffer;
+
+        for (size_t i = 0; i < memory_tag_count; ++i) {
+            auto const tag  = static_cast<memory_tag>(i);
+            auto const s    = memory_stats(tag);
+            auto const name = to_string(tag);
+
+            buffer.clear();
+            buffer.append("%-8.*s %8zu KiB (peak %8zu KiB) %8zu allocations"
+              , static_cast<int>(name.size()), name.data()
+              , s.current_bytes / 1024u, s.peak_bytes / 1024u, s.allocations);
+
+            println(buffer);
+        }
+    }
+
+    //! toggle the profiler overlay; while it is visible the profile of each
+    //! frame is also streamed to frame_profile.json as a Chrome trace.
+    void do_debug_profiler() {
+        auto& profiler = renderer.profiler();
+
+        if (r_profiler.visible(!r_profiler.is_visible())) {
+            profiler.close_output();
+            println("Frame profiler stopped.");
+            return;
+        }
+
+        auto const filename = "frame_profile.json";
+        if (!profiler.open_output(filename, frame_profiler::output_format::chrome_trace)) {
+            println("Couldn't open the frame profile output.");
+            return;
+        }
+
+        static_string_buffer<128> buffer;
+        buffer.append("Frame profiler started; writing to %s.", filename);
+        println(buffer);
+    }
+
     void do_debug_teleport_self() {
         println("Teleport where?");
 
@@ -1845,6 +2034,10 @@ struct game_state {
             return true;
         });
 
+        if (result > 0) {
+            e->items_changed();
+        }
+
         if (result > 0 && &loc.lvl == &current_level()) {
             renderer_update_pile(loc);
         }
@@ -1857,7 +2050,7 @@ struct game_state {
         BK_ASSERT(!!ent && ent.get() == e->instance());
 
         static_string_buffer<128> buffer;
-        buffer.append("The %s dies.", name_of_decorated(ctx, e).data());
+        buffer.format("The {} dies.", e);
         println(buffer);
 
         get_entity_loot(e, {current_level(), p});
@@ -2106,6 +2299,14 @@ struct game_state {
         return boken::create_object(database, the_world, def, rng);
     }
 
+    std::vector<unique_entity> create_objects(entity_definition const& def, random_state& rng, size_t const n) {
+        return boken::create_objects(database, the_world, def, rng, n);
+    }
+
+    std::vector<unique_item> create_objects(item_definition const& def, random_state& rng, size_t const n) {
+        return boken::create_objects(database, the_world, def, rng, n);
+    }
+
     entity_instance_id create_object_at(entity_definition const& def, level_location const loc, random_state& rng) {
         return loc->add_object_at(create_object(def, rng), loc);
     }
@@ -2252,7 +2453,7 @@ struct game_state {
     //! Update the rendering scale.
     //! @pre sx > 0 && sy > 0
     void update_view_scale(float const sx, float const sy) noexcept {
-        update_view(sx, sy, current_view.x_off, current_view.y_off);
+        update_view(sx, sy, current_view.x_off(), current_view.y_off());
     }
 
     void update_view_scale(point2f const scale) noexcept {
@@ -2261,7 +2462,7 @@ struct game_state {
 
     //! Update the rendering offset (translation).
     void update_view_trans(float const dx, float const dy) {
-        update_view(current_view.scale_x, current_view.scale_y, dx, dy);
+        update_view(current_view.scale_x(), current_view.scale_y(), dx, dy);
     }
 
     void update_view_trans(point2f const trans) noexcept {
@@ -2275,10 +2476,8 @@ struct game_state {
     ) noexcept {
         BK_ASSERT(sx > 0.0f && sy > 0.0f);
 
-        current_view.scale_x = sx;
-        current_view.scale_y = sy;
-        current_view.x_off   = dx;
-        current_view.y_off   = dy;
+        current_view.set_scale(sx, sy);
+        current_view.set_offset(dx, dy);
 
         update_highlight_tile();
     }
@@ -2313,32 +2512,83 @@ struct game_state {
           , std::is_convertible<std::decay_t<T>, const_level_location> {});
     }
 
-    //! Render the game
-    void render(timepoint_t const last_frame) {
+    static constexpr clock_t::duration frame_time() noexcept {
         using namespace std::chrono;
+        return duration_cast<clock_t::duration>(seconds {1}) / 60;
+    }
 
-        constexpr auto frame_time =
-            duration_cast<nanoseconds>(seconds {1}) / 60;
-
+    //! Render the game if anything has changed since the last frame.
+    //! @returns false if it is too soon after the last frame to render.
+    bool render(timepoint_t const last_frame) {
         auto const now   = clock_t::now();
         auto const delta = now - last_frame;
 
-        if (delta < frame_time) {
-            return;
+        if (delta < frame_time()) {
+            return false;
         }
 
-        renderer.render(delta, current_view);
+        if (renderer.render(delta, current_view)) {
+            last_frame_time = now;
+        }
 
-        last_frame_time = now;
+        return true;
     }
 
-    //! The main game loop
+    //! The main game loop. Nothing changes except in response to an event, a
+    //! timer, or an animation in a render task. So between frames the loop
+    //! sleeps until the earliest of: the next event, the next timer deadline
+    //! or, if a frame is pending, the next frame deadline.
     void run() {
+        using namespace std::chrono;
+
+        // the longest time to wait for before checking is_running again
+        constexpr auto max_wait = milliseconds {500};
+
+        bool frame_pending = true;
+
+        // messages printed while handling events and timers are laid out
+        // together, once per iteration.
+        message_window.begin_batch();
+
         while (os.is_running()) {
-            timers.update();
-            os.do_events();
-            render(last_frame_time);
+            flush_mouse_move();
+
+            if (timers.update() > 0) {
+                frame_pending = true;
+            }
+
+            // everything the game has done since the last iteration is
+            // complete; lay out the messages it produced all at once.
+            message_window.end_batch();
+
+            if (renderer.is_dirty()) {
+                frame_pending = true;
+            }
+
+            if (frame_pending && render(last_frame_time)) {
+                frame_pending = renderer.is_dirty();
+            }
+
+            auto const now = clock_t::now();
+
+            auto deadline = std::min(timers.next_deadline(), now + max_wait);
+            if (frame_pending) {
+                deadline = std::min(deadline, last_frame_time + frame_time());
+            }
+
+            // round up so as to not wake just before the deadline
+            auto const timeout = duration_cast<milliseconds>(
+                std::max(deadline - now, clock_t::duration {})
+              + milliseconds {1} - clock_t::duration {1});
+
+            message_window.begin_batch();
+
+            if (os.wait_events(timeout) > 0) {
+                frame_pending = true;
+            }
         }
+
+        message_window.end_batch();
     }
 
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -2348,13 +2598,18 @@ struct game_state {
         template <typename T>
         using up = std::unique_ptr<T> const;
 
+        // the game data is loaded while the system and renderer, and their
+        // textures, are set up; it is joined before anything uses it.
+        std::future<std::unique_ptr<game_database>> database_future
+            = std::async(std::launch::async, make_game_database);
+
         up<system>             system_ptr          = make_system();
         up<random_state>       rng_substantive_ptr = make_random_state();
         up<random_state>       rng_superficial_ptr = make_random_state();
-        up<game_database>      database_ptr        = make_game_database();
-        up<world>              world_ptr           = make_world();
         up<text_renderer>      trender_ptr         = make_text_renderer();
         up<game_renderer>      renderer_ptr        = make_game_renderer(*system_ptr, *trender_ptr);
+        up<game_database>      database_ptr        = database_future.get();
+        up<world>              world_ptr           = make_world();
         up<command_translator> cmd_translator_ptr  = make_command_translator();
         up<message_log>        messsage_window_ptr = make_message_log(*trender_ptr);
 
@@ -2397,6 +2652,9 @@ struct game_state {
     tool_tip_renderer& tool_tip = renderer.add_task(
         "tool tip", make_tool_tip_renderer(trender), 0);
 
+    profiler_renderer& r_profiler = renderer.add_task(
+        "profiler", make_profiler_renderer(trender, renderer.profiler()), 0);
+
     input_context_stack context_stack;
 
     view current_view;
@@ -2404,6 +2662,29 @@ struct game_state {
     int last_mouse_x = 0;
     int last_mouse_y = 0;
 
+    mouse_event  pending_mouse_move {};
+    kb_modifiers pending_mouse_kmods {};
+    bool         has_pending_mouse_move = false;
+
+    //! identifies what the tool tip currently shows.
+    struct tool_tip_key_t {
+        point2i32 p;
+        size_t    level_id;
+        uint32_t  level_version;
+        uint32_t  objects_version;
+        bool      debug;
+
+        bool operator==(tool_tip_key_t const& other) const noexcept {
+            return p               == other.p
+                && level_id        == other.level_id
+                && level_version   == other.level_version
+                && objects_version == other.objects_version
+                && debug           == other.debug;
+        }
+    };
+
+    tool_tip_key_t tool_tip_key {{-1, -1}, 0, 0, 0, false};
+
     point2i32 highlighted_tile {-1, -1};
 
     std::vector<point2i32> player_path_;
@@ -2417,14 +2698,14 @@ struct game_state {
 
 namespace {
 #if defined(BK_NO_TESTS)
-void run_tests() {
+void run_tests(int, char const* const*) {
 }
 #else
-void run_tests() {
+void run_tests(int const argc, char const* const* const argv) {
     using namespace std::chrono;
 
     auto const beg = high_resolution_clock::now();
-    boken::run_unit_tests();
+    boken::run_unit_tests(argc, argv);
     auto const end = high_resolution_clock::now();
 
     std::printf("Tests took %" PRId64 " microseconds.\n",
@@ -2434,10 +2715,16 @@ void run_tests() {
 } // namespace
 
 int main(int const argc, char const* argv[]) try {
-    run_tests();
+    run_tests(argc, argv);
 
-    boken::game_state game;
-    game.run();
+    {
+        boken::game_state game;
+        game.run();
+    }
+
+    if (!boken::write_memory_stats("memory_stats.json")) {
+        std::printf("Failed to write memory statistics.\n");
+    }
 
     return 0;
 } catch (std::exception const& e) {
@@ -0,0 +1,107 @@
+#include "memory_stats.hpp"
+
+#include <bkassert/assert.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+
+namespace boken {
+
+string_view to_string(memory_tag const tag) noexcept {
+    switch (tag) {
+    case memory_tag::world   : return "world";
+    case memory_tag::level   : return "level";
+    case memory_tag::pathing : return "pathing";
+    case memory_tag::render  : return "render";
+    case memory_tag::text    : return "text";
+    case memory_tag::ui      : return "ui";
+    case memory_tag::data    : return "data";
+    default                  : break;
+    }
+
+    return "{invalid}";
+}
+
+#if defined(BK_MEMORY_STATS)
+
+namespace {
+
+struct counters_t {
+    std::atomic<size_t> current_bytes;
+    std::atomic<size_t> peak_bytes;
+    std::atomic<size_t> allocations;
+    std::atomic<size_t> deallocations;
+};
+
+// zero initialized before any dynamic initialization takes place
+std::array<counters_t, memory_tag_count> counters;
+
+counters_t& counters_for(memory_tag const tag) noexcept {
+    auto const i = static_cast<size_t>(tag);
+    BK_ASSERT(i < memory_tag_count);
+    return counters[i];
+}
+
+} // namespace
+
+void detail::memory_stats_allocate(memory_tag const tag, size_t const bytes) noexcept {
+    auto& c = counters_for(tag);
+
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    auto const current = c.current_bytes.fetch_add(bytes, std::memory_order_relaxed)
+                       + bytes;
+
+    auto peak = c.peak_bytes.load(std::memory_order_relaxed);
+    while (current > peak
+        && !c.peak_bytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)
+    ) {
+    }
+}
+
+void detail::memory_stats_deallocate(memory_tag const tag, size_t const bytes) noexcept {
+    auto& c = counters_for(tag);
+
+    c.deallocations.fetch_add(1, std::memory_order_relaxed);
+    c.current_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+memory_stats_t memory_stats(memory_tag const tag) noexcept {
+    auto const& c = counters_for(tag);
+
+    return {c.current_bytes.load(std::memory_order_relaxed)
+          , c.peak_bytes.load(std::memory_order_relaxed)
+          , c.allocations.load(std::memory_order_relaxed)
+          , c.deallocations.load(std::memory_order_relaxed)};
+}
+
+bool write_memory_stats(char const* const filename) noexcept {
+    auto const out = std::fopen(filename, "w");
+    if (!out) {
+        return false;
+    }
+
+    std::fprintf(out, "{\n");
+
+    for (size_t i = 0; i < memory_tag_count; ++i) {
+        auto const tag = static_cast<memory_tag>(i);
+        auto const s   = memory_stats(tag);
+        auto const name = to_string(tag);
+
+        std::fprintf(out
+          , "  \"%.*s\": {\"current_bytes\": %zu, \"peak_bytes\": %zu"
+            ", \"allocations\": %zu, \"deallocations\": %zu}%s\n"
+          , static_cast<int>(name.size()), name.data()
+          , s.current_bytes, s.peak_bytes, s.allocations, s.deallocations
+          , (i + 1 < memory_tag_count) ? "," : "");
+    }
+
+    std::fprintf(out, "}\n");
+
+    return std::fclose(out) == 0;
+}
+
+#endif // defined(BK_MEMORY_STATS)
+
+} // namespace boken
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "config.hpp" // for string_view
+
+#include <memory>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+//! Per-subsystem memory accounting.
+//!
+//! Containers owned by a subsystem use tracked_vector<T, Tag> (or a
+//! tracked_allocator<T, Tag> directly) so that their allocations are counted
+//! against that subsystem. Define BK_MEMORY_STATS to enable the accounting;
+//! otherwise tracked_allocator is just std::allocator and every query reports
+//! zero.
+
+namespace boken {
+
+enum class memory_tag : uint8_t {
+    world, level, pathing, render, text, ui, data
+};
+
+constexpr size_t memory_tag_count = 7;
+
+struct memory_stats_t {
+    size_t current_bytes;
+    size_t peak_bytes;
+    size_t allocations;
+    size_t deallocations;
+};
+
+string_view to_string(memory_tag tag) noexcept;
+
+#if defined(BK_MEMORY_STATS)
+
+constexpr bool memory_stats_enabled() noexcept { return true; }
+
+namespace detail {
+void memory_stats_allocate(memory_tag tag, size_t bytes) noexcept;
+void memory_stats_deallocate(memory_tag tag, size_t bytes) noexcept;
+} // namespace detail
+
+//! A std::allocator which counts its allocations against @p Tag.
+template <typename T, memory_tag Tag>
+class tracked_allocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = tracked_allocator<U, Tag>;
+    };
+
+    tracked_allocator() noexcept = default;
+
+    template <typename U>
+    tracked_allocator(tracked_allocator<U, Tag> const&) noexcept {}
+
+    T* allocate(size_t const n) {
+        auto const result = std::allocator<T> {}.allocate(n);
+        detail::memory_stats_allocate(Tag, n * sizeof(T));
+        return result;
+    }
+
+    void deallocate(T* const p, size_t const n) noexcept {
+        detail::memory_stats_deallocate(Tag, n * sizeof(T));
+        std::allocator<T> {}.deallocate(p, n);
+    }
+};
+
+template <typename T, typename U, memory_tag Tag>
+constexpr bool operator==(tracked_allocator<T, Tag> const&, tracked_allocator<U, Tag> const&) noexcept {
+    return true;
+}
+
+template <typename T, typename U, memory_tag Tag>
+constexpr bool operator!=(tracked_allocator<T, Tag> const&, tracked_allocator<U, Tag> const&) noexcept {
+    return false;
+}
+
+//! The current statistics for @p tag.
+memory_stats_t memory_stats(memory_tag tag) noexcept;
+
+//! Write the statistics for every tag to @p filename as a JSON object.
+//! @returns false if the file couldn't be written.
+bool write_memory_stats(char const* filename) noexcept;
+
+#else
+
+constexpr bool memory_stats_enabled() noexcept { return false; }
+
+template <typename T, memory_tag Tag>
+using tracked_allocator = std::allocator<T>;
+
+inline memory_stats_t memory_stats(memory_tag) noexcept {
+    return {};
+}
+
+inline bool write_memory_stats(char const*) noexcept {
+    return true;
+}
+
+#endif
+
+template <typename T, memory_tag Tag>
+using tracked_vector = std::vector<T, tracked_allocator<T, Tag>>;
+
+} // namespace boken
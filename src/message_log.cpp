@@ -1,10 +1,16 @@
 #include "message_log.hpp"
-#include "circular_buffer.hpp"
 #include "text.hpp"
+#include "unicode.hpp"
+#include "memory_stats.hpp"
+#include "math.hpp"
+
+#include "bkassert/assert.hpp"
 
 #include <vector>
 #include <algorithm>
 #include <iterator>
+#include <memory>
+#include <cstring>
 #include <cstdint>
 #include <cstddef>
 
@@ -12,6 +18,118 @@ namespace boken {
 
 message_log::~message_log() = default;
 
+namespace {
+
+//! the maximum number of messages kept.
+constexpr size_t max_messages = size_t {1} << 16;
+
+//! the size of each block of storage for the text of messages, and the
+//! maximum number of them; at most 4 MiB.
+constexpr size_t arena_block_size = size_t {64} * 1024u;
+constexpr size_t max_arena_blocks = 64u;
+
+constexpr size_t no_message = static_cast<size_t>(-1);
+
+//=====--------------------------------------------------------------------=====
+// Append only storage for text. Storage is allocated in large blocks, and
+// released, oldest block first, once nothing refers to it.
+//=====--------------------------------------------------------------------=====
+class text_arena {
+public:
+    struct span_t {
+        uint32_t block;  //!< the id of the block holding the text
+        uint32_t offset; //!< the offset of the text within the block
+        uint32_t size;
+    };
+
+    span_t append(string_view const s) {
+        auto const n = s.size();
+
+        if (blocks_.empty() || blocks_.back().capacity - blocks_.back().size < n) {
+            auto const capacity = std::max(arena_block_size, n);
+            blocks_.push_back({std::make_unique<char[]>(capacity), 0u, capacity});
+        }
+
+        auto& b = blocks_.back();
+        auto const result = span_t {
+            static_cast<uint32_t>(first_block_ + blocks_.size() - 1u)
+          , static_cast<uint32_t>(b.size)
+          , static_cast<uint32_t>(n)};
+
+        std::memcpy(b.data.get() + b.size, s.data(), n);
+        b.size += n;
+
+        return result;
+    }
+
+    //! append @p s to the text in @p span; the text is moved if it isn't the
+    //! last appended, or if there isn't enough space left in its block.
+    void extend(span_t& span, string_view const s) {
+        auto const n = s.size();
+        auto& b = block_(span.block);
+
+        auto const is_last = (&b == &blocks_.back())
+                          && (span.offset + span.size == b.size);
+
+        if (is_last && b.capacity - b.size >= n) {
+            std::memcpy(b.data.get() + b.size, s.data(), n);
+            b.size    += n;
+            span.size += static_cast<uint32_t>(n);
+            return;
+        }
+
+        std::string text = get(span).to_string();
+        text.append(s.data(), n);
+        span = append(text);
+    }
+
+    //! release the storage used by @p span if it was the last appended.
+    void pop(span_t const span) noexcept {
+        auto& b = block_(span.block);
+        if (&b == &blocks_.back() && span.offset + span.size == b.size) {
+            b.size -= span.size;
+        }
+    }
+
+    string_view get(span_t const span) const noexcept {
+        auto const& b = const_cast<text_arena*>(this)->block_(span.block);
+        return {b.data.get() + span.offset, span.size};
+    }
+
+    //! release every block older than @p block.
+    void release_before(uint32_t const block) {
+        BK_ASSERT(block >= first_block_);
+
+        auto const n = std::min<size_t>(block - first_block_, blocks_.size());
+        blocks_.erase(begin(blocks_), begin(blocks_) + static_cast<ptrdiff_t>(n));
+        first_block_ += static_cast<uint32_t>(n);
+    }
+
+    size_t block_count() const noexcept {
+        return blocks_.size();
+    }
+
+    uint32_t first_block() const noexcept {
+        return first_block_;
+    }
+private:
+    struct block_t {
+        std::unique_ptr<char[]> data;
+        size_t                  size;
+        size_t                  capacity;
+    };
+
+    block_t& block_(uint32_t const id) noexcept {
+        BK_ASSERT(id >= first_block_ && id - first_block_ < blocks_.size());
+        return blocks_[id - first_block_];
+    }
+
+    tracked_vector<block_t, memory_tag::ui> blocks_;
+    uint32_t first_block_ {0}; //!< the id of blocks_[0]
+};
+
+} // namespace
+
 class message_log_impl final : public message_log {
 public:
     explicit message_log_impl(text_renderer& trender)
@@ -20,94 +138,483 @@ public:
     }
 
     void print(std::string msg) final override {
-
+        append_(msg);
+        commit_();
     }
 
-    void update_buffer_() {
-        buffer_.clear();
+    void println(std::string msg) final override {
+        append_(msg);
+        is_open_ = false;
+        coalesce_();
+        commit_();
+    }
 
-        auto const first = begin(visible_lines_);
-        auto const last  = end(visible_lines_);
-        std::transform(first, last, back_inserter(buffer_)
-          , [](auto const& l) noexcept { return std::cref(l); });
+    void begin_batch() noexcept final override {
+        ++batch_depth_;
     }
 
-    void println(std::string msg) final override;
+    void end_batch() final override {
+        BK_ASSERT(batch_depth_ > 0);
+        --batch_depth_;
+        commit_();
+    }
 
     recti32 bounds() const noexcept final override {
         return bounds_;
     }
 
     recti32 client_bounds() const noexcept final override {
+        update_visible_();
         return client_bounds_;
     }
 
-    void resize_to(recti32 const r) final override {
-        BK_ASSERT(value_cast(r.width())  > 0
-               && value_cast(r.height()) > 0);
+    void resize_to(recti32 r) final override;
+
+    //--------------------------------------------------------------------------
+    size_t size() const noexcept final override {
+        return messages_.size() - first_;
+    }
+
+    string_view message(size_t const i) const noexcept final override {
+        BK_ASSERT(i < size());
+        return arena_.get(messages_[first_ + i].text);
+    }
+
+    sizei32y content_height() const noexcept final override {
+        return static_cast<int32_t>(content_bottom_() - content_top_());
+    }
+
+    //--------------------------------------------------------------------------
+    int32_t scroll_offset() const noexcept final override {
+        return scroll_offset_;
+    }
+
+    void scroll_to(int32_t offset) noexcept final override;
 
-        bounds_ = r;
+    void scroll_by(int32_t const pixels) noexcept final override {
+        scroll_to(scroll_offset_ + pixels);
     }
 
+    void scroll_by_messages(int n) noexcept final override;
+
+    //--------------------------------------------------------------------------
     int visible_size() const noexcept final override {
-        return static_cast<int>(visible_lines_.size());
+        update_visible_();
+        return static_cast<int>(buffer_.size());
     }
 
     ref const* visible_begin() const noexcept final override {
+        update_visible_();
         return buffer_.data();
     }
 
     ref const* visible_end() const noexcept final override {
+        update_visible_();
         return buffer_.data() + static_cast<ptrdiff_t>(buffer_.size());
     }
 
+    uint32_t version() const noexcept final override {
+        return version_;
+    }
+private:
+    struct message_t {
+        text_arena::span_t text;
+        int64_t  top;         //!< the sum of the heights of every message before it
+        int32_t  height;      //!< the height when laid out at the current width
+        uint32_t id;          //!< unique to each message; changes with the message
+        uint32_t count;       //!< the number of times the message was repeated
+        uint32_t length;      //!< the number of code points in text
+        bool     is_measured; //!< false while height is only an estimate
+    };
+
+    struct line_t {
+        text_layout text;
+        uint32_t    id; //!< the id of the message laid out
+    };
+
+    message_t const* messages_begin_() const noexcept {
+        return messages_.data() + first_;
+    }
+
+    message_t const* messages_end_() const noexcept {
+        return messages_.data() + messages_.size();
+    }
+
+    int64_t content_top_() const noexcept {
+        return size() ? messages_[first_].top : 0;
+    }
+
+    int64_t content_bottom_() const noexcept {
+        return size() ? messages_.back().top + messages_.back().height : 0;
+    }
+
+    int32_t max_scroll_offset_() const noexcept {
+        auto const h = content_bottom_() - content_top_()
+                     - value_cast(bounds_.height());
+        return static_cast<int32_t>(std::max(int64_t {0}, h));
+    }
+
+    sizei16x max_width_() const noexcept {
+        return underlying_cast_unsafe<int16_t>(bounds_.width());
+    }
+
+    //! the text of @p m as shown; repeated messages show a count.
+    std::string display_text_(message_t const& m) const;
+
+    //! the height of @p m when laid out at the current width, estimated from
+    //! the length of its text without laying it out.
+    int32_t estimate_height_(message_t const& m) const noexcept;
+
+    //! recompute the position of each message from the @p i th on after the
+    //! height of the @p i th has changed.
+    void reposition_from_(size_t i) const noexcept;
+
+    //! append @p msg without adding it to the height index.
+    void append_(string_view msg);
+
+    //! merge the most recent message into the one before if they are the
+    //! same.
+    void coalesce_();
+
+    //! unless a batch is in progress, estimate the height of each message
+    //! added or changed since the last commit and make the changes visible.
+    void commit_();
+
+    //! discard the oldest messages while over the limits on their number or
+    //! the storage used.
+    void trim_();
+
+    void invalidate_() noexcept {
+        is_visible_dirty_ = true;
+        ++version_;
+    }
+
+    //! lay out, as required, the messages intersecting the window, correcting
+    //! their heights if they were estimated.
+    void update_visible_() const;
 private:
     text_renderer& trender_;
     recti32        bounds_ {point2i32 {}, sizei32x {500}, sizei32y {200}};
-    recti32        client_bounds_ {};
+    uint32_t       version_ {};
+
+    text_arena arena_;
+    tracked_vector<message_t, memory_tag::ui> mutable messages_;
+    size_t   first_   {0}; //!< the oldest message not yet discarded
+    uint32_t next_id_ {0};
+    bool     is_open_ {false};
+
+    int    batch_depth_ {0};
+    size_t uncommitted_ {no_message}; //!< the first message added or changed
+
+    int32_t mutable scroll_offset_ {0};
+
+    recti32 mutable client_bounds_ {};
+    bool    mutable is_visible_dirty_ {true};
 
-    std::vector<ref>                    buffer_;
-    simple_circular_buffer<text_layout> visible_lines_ {10};
-    simple_circular_buffer<std::string> messages_      {50};
+    tracked_vector<line_t, memory_tag::ui> mutable lines_;
+    tracked_vector<line_t, memory_tag::ui> mutable lines_swap_;
+    std::vector<ref>                       mutable buffer_;
 };
 
 std::unique_ptr<message_log> make_message_log(text_renderer& trender) {
     return std::make_unique<message_log_impl>(trender);
 }
 
-void message_log_impl::println(std::string msg) {
-    auto const bounds_r = bounds();
-    auto const max_w    = underlying_cast_unsafe<int16_t>(bounds_r.width());
-    auto const p        = bounds_r.top_left();
+std::string message_log_impl::display_text_(message_t const& m) const {
+    auto result = arena_.get(m.text).to_string();
+    if (m.count > 1u) {
+        result += " (x" + std::to_string(m.count) + ")";
+    }
+
+    return result;
+}
+
+int32_t message_log_impl::estimate_height_(message_t const& m) const noexcept {
+    // the text as shown; a count follows a repeated message as " (xN)"
+    auto n = int64_t {m.length};
+    if (m.count > 1u) {
+        n += 4;
+        for (auto c = m.count; c; c /= 10u) {
+            ++n;
+        }
+    }
+
+    // every glyph has the same advance; long words wrap early, so this is
+    // more often too small than too large
+    auto const per_line = std::max(1, value_cast(max_width_()) / std::max(1, trender_.glyph_advance()));
+    auto const lines    = (n + per_line - 1) / per_line;
+
+    return static_cast<int32_t>(lines * trender_.line_gap());
+}
+
+void message_log_impl::reposition_from_(size_t const i) const noexcept {
+    BK_ASSERT(i >= first_ && i < messages_.size());
+
+    auto const old_bottom = content_bottom_();
+
+    auto top = messages_[i].top;
+    for (auto j = i; j < messages_.size(); ++j) {
+        auto& m = messages_[j];
+        m.top = top;
+        top += m.height;
+    }
+
+    // keep the same messages in view while scrolled back
+    if (scroll_offset_ > 0) {
+        scroll_offset_ += static_cast<int32_t>(content_bottom_() - old_bottom);
+    }
+
+    scroll_offset_ = clamp(scroll_offset_, 0, max_scroll_offset_());
+}
+
+void message_log_impl::append_(string_view const msg) {
+    auto const length = static_cast<uint32_t>(
+        code_point_count(msg.data(), msg.data() + msg.size()));
+
+    if (is_open_ && size()) {
+        auto& m = messages_.back();
+        arena_.extend(m.text, msg);
+        m.id      = next_id_++;
+        m.length += length;
+    } else {
+        messages_.push_back({arena_.append(msg), content_bottom_(), 0
+          , next_id_++, 1u, length, false});
+    }
+
+    is_open_ = true;
+    uncommitted_ = std::min(uncommitted_, messages_.size() - 1u);
+}
+
+void message_log_impl::coalesce_() {
+    if (size() < 2u) {
+        return;
+    }
+
+    auto const  i    = messages_.size() - 2u;
+    auto&       prev = messages_[i];
+    auto const& last = messages_[i + 1u];
+
+    if (arena_.get(prev.text) != arena_.get(last.text)) {
+        return;
+    }
+
+    arena_.pop(last.text);
+    messages_.pop_back();
+
+    ++prev.count;
+    prev.id = next_id_++;
+
+    uncommitted_ = std::min(uncommitted_, i);
+}
+
+void message_log_impl::commit_() {
+    if (batch_depth_ > 0 || uncommitted_ == no_message) {
+        return;
+    }
+
+    // messages not yet committed have no height; those which are in view are
+    // laid out, and their heights corrected, when the window is next updated
+    auto const old_bottom = content_bottom_();
+
+    auto top = (uncommitted_ > first_)
+      ? messages_[uncommitted_ - 1u].top + messages_[uncommitted_ - 1u].height
+      : content_top_();
+
+    for (auto i = uncommitted_; i < messages_.size(); ++i) {
+        auto& m = messages_[i];
+        m.top         = top;
+        m.height      = estimate_height_(m);
+        m.is_measured = false;
+        top += m.height;
+    }
+
+    uncommitted_ = no_message;
+
+    // keep the same messages in view while scrolled back
+    if (scroll_offset_ > 0) {
+        scroll_offset_ += static_cast<int32_t>(content_bottom_() - old_bottom);
+    }
+
+    trim_();
+
+    scroll_offset_ = std::min(scroll_offset_, max_scroll_offset_());
+    invalidate_();
+}
+
+void message_log_impl::trim_() {
+    auto const is_over_limit = [&]() noexcept {
+        return size() > max_messages
+            || (arena_.block_count() > max_arena_blocks && size() > 1u);
+    };
+
+    if (!is_over_limit()) {
+        return;
+    }
+
+    while (size() > max_messages) {
+        ++first_;
+    }
+
+    while (arena_.block_count() > max_arena_blocks && size() > 1u) {
+        auto const block = arena_.first_block();
+        while (size() > 1u && messages_[first_].text.block == block) {
+            ++first_;
+        }
+
+        arena_.release_before(messages_[first_].text.block);
+    }
+
+    // reclaim the space used by discarded messages once it makes up half
+    if (first_ * 2u >= messages_.size()) {
+        messages_.erase(begin(messages_), begin(messages_) + static_cast<ptrdiff_t>(first_));
+        first_ = 0;
+    }
+}
+
+void message_log_impl::resize_to(recti32 const r) {
+    BK_ASSERT(value_cast(r.width())  > 0
+           && value_cast(r.height()) > 0);
+
+    auto const is_width_changed = r.width() != bounds_.width();
+    bounds_ = r;
+
+    // every height changes with the width; until each message is laid out
+    // again, as it comes into view, its height is only estimated
+    if (is_width_changed) {
+        auto top = int64_t {0};
+        for (size_t i = first_; i < messages_.size(); ++i) {
+            auto& m = messages_[i];
+            m.top         = top;
+            m.height      = estimate_height_(m);
+            m.is_measured = false;
+            top += m.height;
+        }
+
+        lines_.clear();
+    }
+
+    scroll_to(scroll_offset_);
+    invalidate_();
+}
+
+void message_log_impl::scroll_to(int32_t const offset) noexcept {
+    auto const n = clamp(offset, 0, max_scroll_offset_());
+    if (n == scroll_offset_) {
+        return;
+    }
+
+    scroll_offset_ = n;
+    invalidate_();
+}
+
+void message_log_impl::scroll_by_messages(int const n) noexcept {
+    if (!size() || !n) {
+        return;
+    }
+
+    auto const first = messages_begin_();
+    auto const last  = messages_end_();
+
+    // the message at the bottom of the window
+    auto const y  = content_bottom_() - scroll_offset_;
+    auto const it = std::lower_bound(first, last, y
+      , [](message_t const& m, int64_t const bottom) noexcept {
+            return m.top + m.height < bottom;
+        });
+
+    auto const i = std::distance(first, it) - n;
+    auto const j = clamp(i, ptrdiff_t {0}, std::distance(first, last) - 1);
+    auto const& m = first[j];
+
+    scroll_to(static_cast<int32_t>(content_bottom_() - (m.top + m.height)));
+}
+
+void message_log_impl::update_visible_() const {
+    if (!is_visible_dirty_) {
+        return;
+    }
+
+    is_visible_dirty_ = false;
+
+    auto const window_h = int64_t {value_cast(bounds_.height())};
+    auto const p        = bounds_.top_left();
 
     auto actual_w = int32_t {0};
     auto actual_h = int32_t {0};
 
-    auto x = value_cast(p.x);
-    auto y = value_cast(p.y);
+    // laying out a message corrects its estimated height, which moves those
+    // after it and can change which are in view; each message is corrected at
+    // most once for each width, so this is repeated rarely, and not for long.
+    for (auto changed = size_t {0}; changed != no_message; ) {
+        changed = no_message;
+
+        // the range of content, in the same units as message_t::top, shown
+        auto const content_h = content_bottom_() - content_top_();
+        auto const bottom    = content_bottom_() - scroll_offset_;
+        auto const top       = (content_h <= window_h)
+          ? content_top_()
+          : bottom - window_h;
 
-    visible_lines_.push(text_layout {trender_, msg, max_w});
-    messages_.push(std::move(msg));
+        auto const first = std::upper_bound(messages_begin_(), messages_end_(), top
+          , [](int64_t const y, message_t const& m) noexcept {
+                return y < m.top + m.height;
+            });
 
-    for (auto& line : visible_lines_) {
-        auto const r = line.extent();
-        auto const h = value_cast(r.height());
-        auto const w = value_cast(r.width());
+        actual_w = 0;
+        actual_h = 0;
 
-        line.move_to(x, y);
-        y += h;
+        lines_swap_.clear();
 
-        actual_w = std::max(actual_w, w);
+        auto i = static_cast<size_t>(first - messages_.data());
+        for (; i < messages_.size() && messages_[i].top < bottom; ++i) {
+            auto& m = messages_[i];
+
+            // reuse the existing layout if there is one
+            auto const cached = std::find_if(begin(lines_), end(lines_)
+              , [&](line_t const& l) noexcept { return l.id == m.id; });
+
+            if (cached != end(lines_)) {
+                lines_swap_.push_back(std::move(*cached));
+            } else {
+                lines_swap_.push_back({text_layout {trender_
+                  , display_text_(m), max_width_()}, m.id});
+            }
+
+            auto& line = lines_swap_.back().text;
+            auto const y = static_cast<int32_t>(m.top - top);
+
+            line.move_to(value_cast(p.x), value_cast(p.y) + y);
+
+            if (!m.is_measured) {
+                auto const h = value_cast(line.extent().height());
+                if (h != m.height) {
+                    m.height = h;
+                    changed  = std::min(changed, i);
+                }
+
+                m.is_measured = true;
+            }
+
+            actual_w = std::max(actual_w, value_cast(line.extent().width()));
+            actual_h = static_cast<int32_t>(std::min<int64_t>(window_h, y + m.height));
+        }
+
+        using std::swap;
+        swap(lines_, lines_swap_);
+
+        if (changed != no_message) {
+            reposition_from_(changed);
+        }
     }
 
-    actual_h = y;
+    buffer_.clear();
+    std::transform(begin(lines_), end(lines_), back_inserter(buffer_)
+      , [](line_t const& l) noexcept { return std::cref(l.text); });
 
     client_bounds_ = recti32 {
         p
       , sizei32x {actual_w}
       , sizei32y {actual_h}};
-
-    update_buffer_();
 }
 
 } //namespace boken
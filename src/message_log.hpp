@@ -1,34 +1,86 @@
 #pragma once
 
 #include "math_types.hpp"
+#include "config.hpp"
 
 #include <string>
 #include <memory>
+#include <functional>
+
+#include <cstddef>
+#include <cstdint>
 
 namespace boken { class text_renderer; }
 namespace boken { class text_layout; }
 
 namespace boken {
 
+//! The history of messages shown to the player.
 //!
+//! Messages are kept, oldest first, up to a fixed limit on their number and
+//! the memory used to hold them; beyond which the oldest are discarded. Only
+//! messages which are actually visible in the window are laid out.
 class message_log {
 public:
     virtual ~message_log();
 
+    //! append @p msg to the most recent message unless it has been ended.
     virtual void print(std::string msg) = 0;
+
+    //! append @p msg to the most recent message unless it has been ended, and
+    //! then end it. A message the same as the one before is shown as a count
+    //! of repeats instead.
     virtual void println(std::string msg) = 0;
 
+    //! Messages added between begin_batch and the matching end_batch are
+    //! committed together when the batch ends; only then is the window laid
+    //! out again. Batches may nest.
+    virtual void begin_batch() noexcept = 0;
+    virtual void end_batch() = 0;
+
     virtual recti32 bounds() const noexcept = 0;
     virtual recti32 client_bounds() const noexcept = 0;
 
     virtual void resize_to(recti32 r) = 0;
 
+    //--------------------------------------------------------------------------
+
+    //! the number of messages held.
+    virtual size_t size() const noexcept = 0;
+
+    //! the text of the @p i th message held, oldest first.
+    virtual string_view message(size_t i) const noexcept = 0;
+
+    //! the height of every message held when laid out at the current width;
+    //! until a message has been shown at that width, its height is estimated.
+    virtual sizei32y content_height() const noexcept = 0;
+
+    //--------------------------------------------------------------------------
+
+    //! the distance in pixels from the bottom of the most recent message to the
+    //! bottom of the window; 0 if the most recent message is shown.
+    virtual int32_t scroll_offset() const noexcept = 0;
+
+    virtual void scroll_to(int32_t offset) noexcept = 0;
+    virtual void scroll_by(int32_t pixels) noexcept = 0;
+
+    //! scroll back (@p n > 0) or forward (@p n < 0) by whole messages.
+    virtual void scroll_by_messages(int n) noexcept = 0;
+
+    //--------------------------------------------------------------------------
+
     virtual int visible_size() const noexcept = 0;
 
     using ref = std::reference_wrapper<text_layout const>;
 
+    //! the messages intersecting the window, oldest first, positioned in
+    //! window coordinates.
     virtual ref const* visible_begin() const noexcept = 0;
     virtual ref const* visible_end() const noexcept = 0;
+
+    //! incremented whenever a message is added, or the log is resized or
+    //! scrolled.
+    virtual uint32_t version() const noexcept = 0;
 };
 
 std::unique_ptr<message_log> make_message_log(text_renderer& trender);
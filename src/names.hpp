@@ -2,6 +2,7 @@
 
 #include "config.hpp"
 #include "context_fwd.hpp"
+#include "format.hpp"
 
 #include <string>
 
@@ -27,4 +28,11 @@ std::string name_of_decorated(const_context ctx, const_item_descriptor i);
 std::string name_of_decorated(const_context ctx, const_entity_descriptor e);
 //@}
 
+//! Append the "decorated" name for an object to @p buffer. This is also how
+//! string_buffer_base::format writes an object.
+//@{
+bool append_name_of_decorated(string_buffer_base& buffer, const_item_descriptor i) noexcept;
+bool append_name_of_decorated(string_buffer_base& buffer, const_entity_descriptor e) noexcept;
+//@}
+
 } // namespace boken
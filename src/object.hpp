@@ -43,11 +43,21 @@ public:
     //! @note No checking is performed as to whether @p itm can be held by this
     //!       object or not. A check must first be performed with can_add_item.
     void add_item(unique_item&& itm) {
+        ++version_;
         items_.add_item(std::move(itm));
     }
 
+    //! @note Any change made to the items held via the mutable overload must
+    //!       be followed by a call to items_changed.
     item_pile const& items() const noexcept { return items_; }
-    item_pile&       items()       noexcept { return items_; } // TODO
+    item_pile&       items()       noexcept { return items_; }
+
+    //! Note that the items held by this object have changed.
+    void items_changed() noexcept { ++version_; }
+
+    //! Incremented whenever the properties or the items held by this object
+    //! (may) have changed.
+    uint32_t version() const noexcept { return version_; }
 
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     //                              Properties
@@ -78,6 +88,7 @@ public:
         property_t       const property
       , property_value_t const value
     ) {
+        ++version_;
         return properties_.add_or_update_property(property, value);
     }
 
@@ -87,14 +98,17 @@ public:
 
     template <typename InputIt>
     int add_or_update_properties(InputIt first, InputIt last) {
+        ++version_;
         return properties_.add_or_update_properties(first, last);
     }
 
     int add_or_update_properties(std::initializer_list<property_pair_t> properties) {
+        ++version_;
         return properties_.add_or_update_properties(properties);
     }
 
     bool remove_property(property_t const property) {
+        ++version_;
         return properties_.remove_property(property);
     }
 private:
@@ -102,6 +116,7 @@ private:
     definition_id_t id_          {0};
     properties_t    properties_;
     item_pile       items_;
+    uint32_t        version_     {0};
 };
 
 } //namespace boken
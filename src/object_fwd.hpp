@@ -2,8 +2,9 @@
 
 #include "types.hpp"
 #include "context_fwd.hpp"
+#include "functional.hpp"
 
-#include <functional>
+#include <vector>
 
 //=====--------------------------------------------------------------------=====
 //                            Forward Declarations
@@ -26,12 +27,19 @@ class random_state;
 namespace boken {
 
 // object creation
-unique_item create_object(world& w, std::function<item (item_instance_id)> const& f);
-unique_entity create_object(world& w, std::function<entity (entity_instance_id)> const& f);
+unique_item create_object(world& w, function_ref<item (item_instance_id)> f);
+unique_entity create_object(world& w, function_ref<entity (entity_instance_id)> f);
 
 unique_item create_object(game_database const& db, world& w, item_definition const& def, random_state& rng);
 unique_entity create_object(game_database const& db, world& w, entity_definition const& def, random_state& rng);
 
+// bulk object creation; the resulting ids are contiguous
+std::vector<unique_item> create_objects(world& w, size_t n, function_ref<item (item_instance_id)> f);
+std::vector<unique_entity> create_objects(world& w, size_t n, function_ref<entity (entity_instance_id)> f);
+
+std::vector<unique_item> create_objects(game_database const& db, world& w, item_definition const& def, random_state& rng, size_t n);
+std::vector<unique_entity> create_objects(game_database const& db, world& w, entity_definition const& def, random_state& rng, size_t n);
+
 // object -> instance
 entity_instance_id get_instance(entity const& e) noexcept;
 entity_instance_id get_instance(const_entity_descriptor e) noexcept;
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "math_types.hpp"
+#include "memory_stats.hpp"
+
+#include <bkassert/assert.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace boken {
+
+//! A layer of objects with at most one object per tile. The data itself is
+//! kept dense and unordered for drawing; slots maps each tile of the level to
+//! the index of its object in data so that updates don't need to search.
+template <typename T, memory_tag Tag>
+struct object_layer {
+    static constexpr int32_t no_slot = -1;
+
+    tracked_vector<T,       Tag> data;
+    tracked_vector<int32_t, Tag> tiles; //!< by slot
+    tracked_vector<int32_t, Tag> slots; //!< by tile
+    int32_t width {};
+
+    void reset(int32_t const w, int32_t const h) {
+        BK_ASSERT(w >= 0 && h >= 0);
+
+        data.clear();
+        tiles.clear();
+        slots.clear();
+        slots.resize(static_cast<size_t>(w * h), int32_t {no_slot});
+        width = w;
+    }
+
+    int32_t tile_index(point2i32 const p) const noexcept {
+        auto const i = value_cast(p.x) + value_cast(p.y) * width;
+        BK_ASSERT(i >= 0 && static_cast<size_t>(i) < slots.size());
+        return i;
+    }
+
+    int32_t& slot_at(int32_t const tile) noexcept {
+        return slots[static_cast<size_t>(tile)];
+    }
+
+    int32_t slot_at(int32_t const tile) const noexcept {
+        return slots[static_cast<size_t>(tile)];
+    }
+
+    void insert(int32_t const tile, T const& d) {
+        BK_ASSERT(slot_at(tile) == no_slot);
+
+        slot_at(tile) = static_cast<int32_t>(data.size());
+        data.push_back(d);
+        tiles.push_back(tile);
+    }
+
+    //! equivalent to data.erase(...), but the last object takes the place of
+    //! the removed one.
+    void erase(int32_t const tile) noexcept {
+        auto const slot = slot_at(tile);
+        BK_ASSERT(slot != no_slot);
+
+        auto const i    = static_cast<size_t>(slot);
+        auto const last = data.size() - 1u;
+
+        if (i != last) {
+            data[i]  = data[last];
+            tiles[i] = tiles[last];
+            slot_at(tiles[i]) = slot;
+        }
+
+        data.pop_back();
+        tiles.pop_back();
+        slot_at(tile) = no_slot;
+    }
+
+    void move(int32_t const from, int32_t const to) noexcept {
+        if (from == to) {
+            return;
+        }
+
+        auto const slot = slot_at(from);
+        BK_ASSERT(slot != no_slot && slot_at(to) == no_slot);
+
+        slot_at(from) = no_slot;
+        slot_at(to)   = slot;
+        tiles[static_cast<size_t>(slot)] = to;
+    }
+};
+
+template <typename T, memory_tag Tag>
+constexpr int32_t object_layer<T, Tag>::no_slot;
+
+} //namespace boken
@@ -1,4 +1,5 @@
 #include "render.hpp"
+#include "format.hpp"
 #include "level.hpp"
 #include "math.hpp"
 #include "rect.hpp"
@@ -9,16 +10,65 @@
 #include "utility.hpp"
 #include "inventory.hpp"
 #include "scope_guard.hpp"
+#include "memory_stats.hpp"
+#include "object_layer.hpp"
 
 #include <bkassert/assert.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
 #include <vector>
+#include <cinttypes>
 #include <cstdint>
+#include <cstdio>
 
 namespace boken {
 
 namespace {
 
+//! the texture id of the font; the source of every glyph in the atlas.
+constexpr uint32_t font_texture_id = 3;
+
+//! Give the glyph atlas of @p tr a texture if it doesn't yet have one, and copy
+//! any glyphs newly placed in the atlas from the font texture.
+void update_glyph_atlas(renderer2d& r, text_renderer& tr) {
+    auto id = tr.atlas_texture();
+    if (id == text_renderer::no_texture) {
+        id = r.create_render_target(tr.atlas_width(), tr.atlas_height());
+        tr.set_atlas_texture(id);
+    }
+
+    auto const& copies = tr.pending_copies();
+    if (copies.empty()) {
+        return;
+    }
+
+    auto const target = r.render_target(id);
+    auto const trans  = r.transform({1.0f, 1.0f, 0.0f, 0.0f});
+
+    // glyphs can reuse the space of those evicted
+    for (auto const& c : copies) {
+        r.clear_rect({c.dest, sizei32x {value_cast(c.size.x)}, sizei32y {value_cast(c.size.y)}});
+    }
+
+    using glyph_copy_t = text_renderer::glyph_copy_t;
+    using ptr_t = read_only_pointer_t;
+
+    auto const color = 0xFFFFFFFFu;
+
+    r.draw_tiles(renderer2d::tile_params_variable {
+        font_texture_id
+      , static_cast<int32_t>(copies.size())
+      , ptr_t {copies, BK_OFFSETOF(glyph_copy_t, dest)}
+      , ptr_t {copies, BK_OFFSETOF(glyph_copy_t, source)}
+      , ptr_t {copies, BK_OFFSETOF(glyph_copy_t, size)}
+      , ptr_t {&color, &color + 1, 0, 0}
+    });
+
+    tr.clear_pending_copies();
+}
+
 void render_text(
     renderer2d& r
   , text_renderer& tr
@@ -30,6 +80,7 @@ void render_text(
     }
 
     text.update(tr);
+    update_glyph_atlas(r, tr);
 
     auto const& glyph_data = text.data();
 
@@ -39,7 +90,7 @@ void render_text(
 
     using ptr_t = read_only_pointer_t;
     auto const params = renderer2d::tile_params_variable {
-        3
+        tr.atlas_texture()
       , static_cast<int32_t>(glyph_data.size())
       , ptr_t {glyph_data, BK_OFFSETOF(text_layout::data_t, position)}
       , ptr_t {glyph_data, BK_OFFSETOF(text_layout::data_t, texture)}
@@ -51,8 +102,29 @@ void render_text(
     r.draw_tiles(params);
 }
 
+//! the next view version; shared by every view so that the versions of two
+//! unrelated views are never equal by accident.
+uint32_t next_view_version() noexcept {
+    static std::atomic<uint32_t> version {0};
+    return ++version;
+}
+
 } //namespace
 
+//=====--------------------------------------------------------------------=====
+//=====--------------------------------------------------------------------=====
+void view::set_offset(float const x, float const y) noexcept {
+    x_off_   = x;
+    y_off_   = y;
+    version_ = next_view_version();
+}
+
+void view::set_scale(float const sx, float const sy) noexcept {
+    scale_x_ = sx;
+    scale_y_ = sy;
+    version_ = next_view_version();
+}
+
 render_task::~render_task() = default;
 
 //=====--------------------------------------------------------------------=====
@@ -69,25 +141,34 @@ public:
     //---render_task interface
     void render(duration_t delta, renderer2d& r, view const& v) final override;
 
+    bool is_dirty() const noexcept final override {
+        return dirty_;
+    }
+
     //---tool_tip_renderer interface
     bool is_visible() const noexcept final override {
         return text_.is_visible();
     }
 
     bool visible(bool const state) noexcept final override {
-        return text_.visible(state);
+        auto const result = text_.visible(state);
+        dirty_ = dirty_ || (result != state);
+        return result;
     }
 
     void set_text(std::string text) final override {
         text_.layout(trender_, std::move(text));
+        dirty_ = true;
     }
 
     void set_position(point2i32 const p) noexcept final override {
         text_.move_to(value_cast(p.x), value_cast(p.y));
+        dirty_ = true;
     }
 private:
     text_renderer& trender_;
     text_layout    text_;
+    bool           dirty_ = true;
 };
 
 std::unique_ptr<tool_tip_renderer> make_tool_tip_renderer(text_renderer& tr) {
@@ -95,6 +176,8 @@ std::unique_ptr<tool_tip_renderer> make_tool_tip_renderer(text_renderer& tr) {
 }
 
 void tool_tip_renderer_impl::render(duration_t, renderer2d& r, view const&) {
+    dirty_ = false;
+
     if (!is_visible()) {
         return;
     }
@@ -166,6 +249,13 @@ public:
     //---render_task interface
     void render(duration_t delta, renderer2d& r, view const& v) final override;
 
+    bool is_dirty() const noexcept final override {
+        return !!log_
+            && (log_->version() != version_
+             || !fading_
+             || fade_time_ < fade_total_time());
+    }
+
     //---message_log_renderer interface
     void resize(vec2i32 const delta) final override {
     }
@@ -190,10 +280,23 @@ public:
     void scroll_reset_v() final override {
     }
 private:
+    static duration_t fade_time() noexcept {
+        return std::chrono::milliseconds {3000};
+    }
+
+    static duration_t fade_lead_time() noexcept {
+        return std::chrono::milliseconds {1000};
+    }
+
+    static duration_t fade_total_time() noexcept {
+        return fade_time() + fade_lead_time();
+    }
+
     message_log const* log_;
     text_renderer& trender_;
     bool fading_ = false;
     duration_t fade_time_ {};
+    uint32_t version_ {}; //!< the version of log_ last rendered
 };
 
 std::unique_ptr<message_log_renderer> make_message_log_renderer(
@@ -208,18 +311,15 @@ void message_log_renderer_impl::render(duration_t const delta, renderer2d& r, vi
         return;
     }
 
-    constexpr std::chrono::milliseconds fade_time      {3000};
-    constexpr std::chrono::milliseconds fade_lead_time {1000};
-    constexpr auto fade_total_time = fade_time + fade_lead_time;
-
     if (fading_ == false) {
         fading_ = true;
         fade_time_ = duration_t {};
-    } else if (fade_time_ < fade_total_time) {
+    } else if (fade_time_ < fade_total_time()) {
         fade_time_ += delta;
     }
 
     auto const& log_window = *log_;
+    version_ = log_window.version();
 
     auto const bounds   = log_window.bounds();
     auto const client_r = log_window.client_bounds();
@@ -235,8 +335,8 @@ void message_log_renderer_impl::render(duration_t const delta, renderer2d& r, vi
 
     auto const trans = r.transform({1.0f, 1.0f, 0.0f, 0.0f});
 
-    auto const t0 = std::chrono::duration<float, std::milli> {fade_time_ - fade_lead_time};
-    auto const t1 = t0 / fade_time;
+    auto const t0 = std::chrono::duration<float, std::milli> {fade_time_ - fade_lead_time()};
+    auto const t1 = t0 / fade_time();
 
     auto const scale = 1.0f - clamp(t1, 0.1f, 0.9f);
     auto const alpha = round_as<uint32_t>(255.0f * scale) & 0xFFu;
@@ -244,6 +344,9 @@ void message_log_renderer_impl::render(duration_t const delta, renderer2d& r, vi
 
     r.fill_rect(bounds, color);
 
+    // the oldest message shown may be only partly within the window
+    auto const clip = r.clip_rect(bounds);
+
     std::for_each(log_window.visible_begin(), log_window.visible_end()
       , [&](text_layout const& line) noexcept {
             if (line.extent().y1 + v.y <= bounds.y0) {
@@ -269,16 +372,23 @@ public:
     //---render_task interface
     void render(duration_t delta, renderer2d& r, view const& v) final override;
 
+    bool is_dirty() const noexcept final override {
+        return dirty_ || (list_ && list_->version() != version_);
+    }
+
     //---tool_tip_renderer interface
     bool set_focus(bool const state) noexcept final override {
         auto const result = has_focus_;
         has_focus_ = state;
+        dirty_ = dirty_ || (result != state);
         return result;
     }
 private:
     text_renderer& trender_;
     inventory_list const* list_;
+    uint32_t version_ {}; //!< the version of list_ last rendered
     bool has_focus_ = false;
+    bool dirty_ = true;
 };
 
 std::unique_ptr<item_list_renderer>
@@ -287,7 +397,15 @@ make_item_list_renderer(text_renderer& tr, inventory_list const& il) {
 }
 
 void item_list_renderer_impl::render(duration_t, renderer2d& r, view const&) {
-    if (!list_ || !list_->is_visible()) {
+    dirty_ = false;
+
+    if (!list_) {
+        return;
+    }
+
+    version_ = list_->version();
+
+    if (!list_->is_visible()) {
         return;
     }
 
@@ -368,19 +486,21 @@ void item_list_renderer_impl::render(duration_t, renderer2d& r, view const&) {
         last_y = std::max(last_y, value_cast(info.text.extent().y1 + v.y));
     }
 
-    auto const indicated = static_cast<size_t>(inv_window.indicated());
+    auto const indicated = inv_window.indicated();
+    auto const visible   = inv_window.visible_rows();
+    auto const h         = inv_window.row_height();
 
-    for (size_t i = 0; i < inv_window.rows(); ++i) {
-        auto const range = inv_window.row(static_cast<int>(i));
+    // only the rows which intersect the client area are drawn (or laid out)
+    for (auto i = visible.first; i < visible.second; ++i) {
+        auto const range = inv_window.row(i);
 
         auto const p = range.first->position() + v;
         auto const w = m.client_frame.width();
-        auto const h = range.first->extent().height();
 
         auto const color =
-            (inv_window.is_selected(static_cast<int>(i))) ? color_row_sel
-          : (i % 2u)                                      ? color_row_even
-                                                          : color_row_odd;
+            (inv_window.is_selected(i)) ? color_row_sel
+          : (i % 2)                     ? color_row_even
+                                        : color_row_odd;
 
         // row background
         auto const row = recti32 {p, w, h};
@@ -395,9 +515,6 @@ void item_list_renderer_impl::render(duration_t, renderer2d& r, view const&) {
         });
 
         last_y = std::max(last_y, value_cast(p.y + h));
-        if (last_y >= value_cast(m.client_frame.y1)) {
-            break;
-        }
     }
 
     // fill unused background
@@ -422,10 +539,15 @@ public:
     //---render_task interface
     void render(duration_t delta, renderer2d& r, view const& v) final override;
 
+    bool is_dirty() const noexcept final override {
+        return dirty_;
+    }
+
     //---map_renderer interface
     bool debug_toggle_show_regions() noexcept final override {
         bool const result = debug_show_regions_;
         debug_show_regions_ = !debug_show_regions_;
+        dirty_ = true;
         return result;
     }
 
@@ -440,11 +562,13 @@ public:
 
         highlight_clear();
         highlighted_tiles_.reserve(static_cast<size_t>(n));
+        dirty_ = true;
 
         std::copy(first, last, back_inserter(highlighted_tiles_));
     }
 
     void highlight_clear() final override {
+        dirty_ = dirty_ || !highlighted_tiles_.empty();
         highlighted_tiles_.clear();
     }
 
@@ -453,12 +577,21 @@ public:
             return;
         }
 
-        entity_data.clear();
-        item_data.clear();
         tile_data.clear();
         highlight_clear();
 
+        // the render targets themselves are kept for reuse
+        chunk_dirty_.clear();
+        chunks_w_ = 0;
+        chunks_h_ = 0;
+
         level_ = &lvl;
+        dirty_ = true;
+
+        auto const w = value_cast(lvl.width());
+        auto const h = value_cast(lvl.height());
+        entities_.reset(w, h);
+        items_.reset(w, h);
     }
 
     void set_tile_maps(
@@ -473,6 +606,8 @@ public:
                 break;
             }
         }
+
+        dirty_ = true;
     }
 
     void set_pile_id(item_id const id) noexcept final override {
@@ -522,18 +657,25 @@ public:
     void update_map_data() final override;
     void update_map_data(const_sub_region_range<tile_id> sub_region) final override;
 
+    void reset_render_targets() noexcept final override {
+        std::fill(begin(chunk_dirty_), end(chunk_dirty_), uint8_t {1});
+        dirty_ = true;
+    }
+
     void update_data(
         update_t<entity_id> const* first
       , update_t<entity_id> const* last
     ) final override {
-        update_data_(entity_data, first, last, *tile_map_entities_);
+        update_data_(entities_, first, last, *tile_map_entities_);
+        dirty_ = dirty_ || (first != last);
     }
 
     void update_data(
         update_t<item_id> const* first
       , update_t<item_id> const* last
     ) final override {
-        update_data_(item_data, first, last, *tile_map_items_);
+        update_data_(items_, first, last, *tile_map_items_);
+        dirty_ = dirty_ || (first != last);
     }
 private:
     item_id get_item_id_(item_id const id) const noexcept {
@@ -548,6 +690,8 @@ private:
         uint32_t  color;
     };
 
+    using object_layer_t = object_layer<data_t, memory_tag::render>;
+
     static auto tile_pos_to_rect_(tile_map const& tmap) noexcept {
         auto const w  = tmap.tile_width();
         auto const h  = tmap.tile_height();
@@ -559,19 +703,153 @@ private:
         };
     }
 
-    template <typename Data, typename T>
+    template <typename Data>
     static renderer2d::tile_params_uniform
-    make_uniform(tile_map const& tmap, T const& data) noexcept {
+    make_uniform(tile_map const& tmap, Data const* const first, Data const* const last) noexcept {
         using ptr_t = read_only_pointer_t;
+        constexpr auto stride = sizeof(Data);
         return {
             tmap.tile_width(), tmap.tile_height(), tmap.texture_id()
-          , static_cast<int32_t>(data.size())
-          , ptr_t {data, BK_OFFSETOF(Data, position)}
-          , ptr_t {data, BK_OFFSETOF(Data, tex_coord)}
-          , ptr_t {data, BK_OFFSETOF(Data, color)}
+          , static_cast<int32_t>(std::distance(first, last))
+          , ptr_t {first, last, BK_OFFSETOF(Data, position),  stride}
+          , ptr_t {first, last, BK_OFFSETOF(Data, tex_coord), stride}
+          , ptr_t {first, last, BK_OFFSETOF(Data, color),     stride}
         };
     }
 
+    template <typename Data, typename T>
+    static renderer2d::tile_params_uniform
+    make_uniform(tile_map const& tmap, T const& data) noexcept {
+        return make_uniform<Data>(tmap, data.data(), data.data() + data.size());
+    }
+
+    //! @returns the area of the level, in tiles, which is visible within
+    //! @p client given the view @p v.
+    recti32 visible_tiles_(recti32 const client, view const& v) const noexcept {
+        auto const& tmap = *tile_map_base_;
+        auto const  tw   = tmap.tile_width();
+        auto const  th   = tmap.tile_height();
+
+        auto const p0 = v.window_to_world(client.top_left(),     tw, th);
+        auto const p1 = v.window_to_world(client.bottom_right(), tw, th);
+
+        auto const r = recti32 {
+            offi32x {floor_as<int32_t>(value_cast(p0.x))}
+          , offi32y {floor_as<int32_t>(value_cast(p0.y))}
+          , offi32x {ceil_as<int32_t>(value_cast(p1.x))}
+          , offi32y {ceil_as<int32_t>(value_cast(p1.y))}};
+
+        return clamp(r, level_->bounds());
+    }
+
+    //! Draw the base map tiles in @p area (in tiles). tile_data is row major
+    //! and covers the entire level, so each row is a contiguous range.
+    void draw_tile_rows_(renderer2d& r, recti32 const area) {
+        auto const w  = value_cast_unsafe<ptrdiff_t>(level_->width());
+        auto const x0 = static_cast<ptrdiff_t>(value_cast(area.x0));
+        auto const n  = static_cast<ptrdiff_t>(value_cast(area.width()));
+        auto const y0 = value_cast(area.y0);
+        auto const y1 = value_cast(area.y1);
+
+        BK_ASSERT(static_cast<ptrdiff_t>(tile_data.size())
+               >= w * value_cast(level_->height()));
+
+        auto const& tmap = *tile_map_base_;
+
+        for (auto y = y0; y < y1; ++y) {
+            auto const first = tile_data.data() + (y * w + x0);
+            r.draw_tiles(make_uniform(tmap, first, first + n));
+        }
+    }
+
+    //! @returns the area of the level, in tiles, covered by the chunk at
+    //! (@p cx, @p cy).
+    recti32 chunk_area_(int32_t const cx, int32_t const cy) const noexcept {
+        auto const x = cx * chunk_size;
+        auto const y = cy * chunk_size;
+
+        return clamp(recti32 {offi32x {x}, offi32y {y}
+                            , offi32x {x + chunk_size}, offi32y {y + chunk_size}}
+                   , level_->bounds());
+    }
+
+    //! size the chunk grid to the current level and mark every chunk dirty.
+    void reset_chunks_() {
+        auto const bounds = level_->bounds();
+
+        chunks_w_ = (value_cast(bounds.width())  + chunk_size - 1) / chunk_size;
+        chunks_h_ = (value_cast(bounds.height()) + chunk_size - 1) / chunk_size;
+
+        chunk_dirty_.clear();
+        chunk_dirty_.resize(static_cast<size_t>(chunks_w_ * chunks_h_), 1u);
+    }
+
+    //! mark every chunk which intersects @p area (in tiles) dirty.
+    void invalidate_chunks_(recti32 const area) noexcept {
+        auto const cx0 = std::max(0, value_cast(area.x0) / chunk_size);
+        auto const cy0 = std::max(0, value_cast(area.y0) / chunk_size);
+        auto const cx1 = std::min(chunks_w_, (value_cast(area.x1) + chunk_size - 1) / chunk_size);
+        auto const cy1 = std::min(chunks_h_, (value_cast(area.y1) + chunk_size - 1) / chunk_size);
+
+        for (auto cy = cy0; cy < cy1; ++cy) {
+            for (auto cx = cx0; cx < cx1; ++cx) {
+                chunk_dirty_[static_cast<size_t>(cx + cy * chunks_w_)] = 1u;
+            }
+        }
+    }
+
+    void update_chunks_(renderer2d& r);
+
+    void render_chunks_(renderer2d& r, recti32 area);
+
+    //! Draw the subset of the objects in @p layer visible in @p area (in
+    //! tiles). Whichever of the objects or the visible tiles is fewer is
+    //! walked.
+    void render_objects_(
+        renderer2d&           r
+      , tile_map       const& tmap
+      , object_layer_t const& layer
+      , recti32        const  area
+    ) {
+        auto const& data = layer.data;
+
+        visible_data_.clear();
+
+        if (value_cast_unsafe<size_t>(area.area()) < data.size()) {
+            auto const x0 = value_cast(area.x0);
+            auto const x1 = value_cast(area.x1);
+            auto const y0 = value_cast(area.y0);
+            auto const y1 = value_cast(area.y1);
+
+            for (auto y = y0; y < y1; ++y) {
+                auto const row = layer.slots.data() + y * layer.width;
+                for (auto x = x0; x < x1; ++x) {
+                    auto const slot = row[x];
+                    if (slot != object_layer_t::no_slot) {
+                        visible_data_.push_back(data[static_cast<size_t>(slot)]);
+                    }
+                }
+            }
+        } else {
+            auto const tw = value_cast(tmap.tile_width());
+            auto const th = value_cast(tmap.tile_height());
+
+            auto const x0 = value_cast(area.x0) * tw;
+            auto const x1 = value_cast(area.x1) * tw;
+            auto const y0 = value_cast(area.y0) * th;
+            auto const y1 = value_cast(area.y1) * th;
+
+            std::copy_if(begin(data), end(data), back_inserter(visible_data_)
+              , [&](data_t const& d) noexcept {
+                    auto const x = value_cast(d.position.x);
+                    auto const y = value_cast(d.position.y);
+                    return x >= x0 && x < x1 && y >= y0 && y < y1;
+                });
+        }
+
+        r.draw_tiles(make_uniform<data_t>(tmap, visible_data_));
+    }
+
     static auto position_to_pixel_(tile_map const& tmap) noexcept {
         auto const tw = value_cast(tmap.tile_width());
         auto const th = value_cast(tmap.tile_height());
@@ -625,9 +903,9 @@ private:
         }
     }
 
-    template <typename Data, typename Type>
+    template <typename Type>
     void update_data_(
-        Data&                       data
+        object_layer_t&             layer
       , update_t<Type> const* const first
       , update_t<Type> const* const last
       , tile_map const&             tmap
@@ -639,43 +917,51 @@ private:
         };
 
         std::for_each(first, last, [&](update_t<Type> const& update) {
-            auto const p = tranform(update.prev_pos);
-
-            auto const first_d = begin(data);
-            auto const last_d  = end(data);
-
-            auto const it = std::find_if(first_d, last_d
-              , [&](data_t const& d) noexcept { return d.position == p; });
+            auto const from = layer.tile_index(update.prev_pos);
+            auto const slot = layer.slot_at(from);
 
             // data to remove
             if (update.id == nullptr) {
-                BK_ASSERT(it != last_d);
-
-                // equivalent to  data.erase(it)
-                std::swap(*it, data.back());
-                data.pop_back();
-
+                layer.erase(from);
                 return;
             }
 
             // new data
-            if (it == last_d) {
-                data.push_back({p, tex_coord(update.id), get_color(update)});
+            if (slot == object_layer_t::no_slot) {
+                layer.insert(from, {tranform(update.prev_pos)
+                                  , tex_coord(update.id), get_color(update)});
                 return;
             }
 
             // data to update
-            it->position  = tranform(update.next_pos);
-            it->tex_coord = tex_coord(update.id);
-            it->color     = get_color(update);
+            layer.move(from, layer.tile_index(update.next_pos));
+
+            auto& d = layer.data[static_cast<size_t>(slot)];
+            d.position  = tranform(update.next_pos);
+            d.tex_coord = tex_coord(update.id);
+            d.color     = get_color(update);
         });
     }
 private:
     level const* level_ {};
 
-    std::vector<data_t> tile_data;
-    std::vector<data_t> entity_data;
-    std::vector<data_t> item_data;
+    tracked_vector<data_t, memory_tag::render> tile_data;
+
+    object_layer_t entities_;
+    object_layer_t items_;
+
+    //!< temporary buffer for the visible subset of entities_ or items_
+    tracked_vector<data_t, memory_tag::render> visible_data_;
+
+    //! The base map layer is cached in render targets of chunk_size x
+    //! chunk_size tiles; a chunk is only redrawn after it has been marked dirty
+    //! by update_map_data.
+    static constexpr int32_t chunk_size = 32;
+
+    tracked_vector<uint32_t, memory_tag::render> chunk_textures_; //!< by chunk
+    tracked_vector<uint8_t,  memory_tag::render> chunk_dirty_;    //!< by chunk
+    int32_t chunks_w_ {};
+    int32_t chunks_h_ {};
 
     tile_map const* tile_map_base_     {};
     tile_map const* tile_map_entities_ {};
@@ -686,6 +972,7 @@ private:
     std::vector<point2i32> highlighted_tiles_;
 
     bool debug_show_regions_ = false;
+    bool dirty_              = true;
 };
 
 std::unique_ptr<map_renderer> make_map_renderer() {
@@ -693,16 +980,27 @@ std::unique_ptr<map_renderer> make_map_renderer() {
 }
 
 void map_renderer_impl::render(duration_t, renderer2d& r, view const& v) {
-     auto const trans = r.transform({v.scale_x, v.scale_y, v.x_off, v.y_off});
+    dirty_ = false;
+
+    auto const trans = r.transform({v.scale_x(), v.scale_y(), v.x_off(), v.y_off()});
+
+    if (!level_) {
+        return;
+    }
+
+    auto const area = visible_tiles_(r.get_client_rect(), v);
 
     // Map tiles
-    r.draw_tiles(make_uniform<data_t>(*tile_map_base_, tile_data));
+    if (!tile_data.empty()) {
+        update_chunks_(r);
+        render_chunks_(r, area);
+    }
 
     // Items
-    r.draw_tiles(make_uniform<data_t>(*tile_map_items_, item_data));
+    render_objects_(r, *tile_map_items_, items_, area);
 
     // Entities
-    r.draw_tiles(make_uniform<data_t>(*tile_map_entities_, entity_data));
+    render_objects_(r, *tile_map_entities_, entities_, area);
 
     // tile highlight
     auto const border_size = 2;
@@ -713,6 +1011,76 @@ void map_renderer_impl::render(duration_t, renderer2d& r, view const& v) {
     }
 }
 
+void map_renderer_impl::update_chunks_(renderer2d& r) {
+    auto const& tmap = *tile_map_base_;
+    auto const  tw   = value_cast(tmap.tile_width());
+    auto const  th   = value_cast(tmap.tile_height());
+
+    while (chunk_textures_.size() < chunk_dirty_.size()) {
+        chunk_textures_.push_back(r.create_render_target(
+            sizei32x {chunk_size * tw}, sizei32y {chunk_size * th}));
+    }
+
+    for (int32_t cy = 0; cy < chunks_h_; ++cy) {
+        for (int32_t cx = 0; cx < chunks_w_; ++cx) {
+            auto const i = static_cast<size_t>(cx + cy * chunks_w_);
+            if (!chunk_dirty_[i]) {
+                continue;
+            }
+
+            auto const area = chunk_area_(cx, cy);
+            auto const x    = static_cast<float>(value_cast(area.x0) * tw);
+            auto const y    = static_cast<float>(value_cast(area.y0) * th);
+
+            auto const target = r.render_target(chunk_textures_[i]);
+            auto const trans  = r.transform({1.0f, 1.0f, -x, -y});
+
+            draw_tile_rows_(r, area);
+            chunk_dirty_[i] = 0u;
+        }
+    }
+}
+
+void map_renderer_impl::render_chunks_(renderer2d& r, recti32 const area) {
+    auto const& tmap = *tile_map_base_;
+    auto const  tw   = value_cast(tmap.tile_width());
+    auto const  th   = value_cast(tmap.tile_height());
+
+    auto const cx0 = value_cast(area.x0) / chunk_size;
+    auto const cy0 = value_cast(area.y0) / chunk_size;
+    auto const cx1 = (value_cast(area.x1) + chunk_size - 1) / chunk_size;
+    auto const cy1 = (value_cast(area.y1) + chunk_size - 1) / chunk_size;
+
+    using ptr_t = read_only_pointer_t;
+
+    for (auto cy = cy0; cy < cy1; ++cy) {
+        for (auto cx = cx0; cx < cx1; ++cx) {
+            auto const i = static_cast<size_t>(cx + cy * chunks_w_);
+            auto const a = chunk_area_(cx, cy);
+
+            auto const pos = point2i16 {
+                static_cast<int16_t>(value_cast(a.x0) * tw)
+              , static_cast<int16_t>(value_cast(a.y0) * th)};
+
+            auto const size = point2i16 {
+                static_cast<int16_t>(value_cast(a.width())  * tw)
+              , static_cast<int16_t>(value_cast(a.height()) * th)};
+
+            auto const tex   = point2i16 {};
+            auto const color = 0xFFFFFFFFu;
+
+            r.draw_tiles(renderer2d::tile_params_variable {
+                chunk_textures_[i]
+              , 1
+              , ptr_t {&pos,   &pos   + 1}
+              , ptr_t {&tex,   &tex   + 1}
+              , ptr_t {&size,  &size  + 1}
+              , ptr_t {&color, &color + 1}
+            });
+        }
+    }
+}
+
 void map_renderer_impl::update_map_data() {
     auto const& tmap   = *tile_map_base_;
     auto const& lvl    = *level_;
@@ -740,6 +1108,9 @@ void map_renderer_impl::update_map_data() {
             out.tex_coord = tex_coord(tid);
             out.color     = choose_color(tid, rid);
         });
+
+    reset_chunks_();
+    dirty_ = true;
 }
 
 void map_renderer_impl::update_map_data(
@@ -763,6 +1134,312 @@ void map_renderer_impl::update_map_data(
             out.tex_coord = tex_coord(tid);
             out.color     = choose_color(tid, rid);
         });
+
+    invalidate_chunks_({point2i32 {x, y}, sizei32x {w}, sizei32y {h}});
+    dirty_ = true;
+}
+
+//=====--------------------------------------------------------------------=====
+//=====--------------------------------------------------------------------=====
+frame_profiler::~frame_profiler() = default;
+
+class frame_profiler_impl final : public frame_profiler {
+public:
+    using clock_t     = render_task::clock_t;
+    using timepoint_t = render_task::timepoint_t;
+
+    frame_profiler_impl()
+      : epoch_ {clock_t::now()}
+    {
+    }
+
+    ~frame_profiler_impl() {
+        close_output();
+    }
+
+    //---frame_profiler interface
+    int64_t frame_count() const noexcept final override {
+        return frame_;
+    }
+
+    task_profile const* begin() const noexcept final override {
+        return last_.data();
+    }
+
+    task_profile const* end() const noexcept final override {
+        return last_.data() + last_.size();
+    }
+
+    bool open_output(char const* filename, output_format format) final override;
+    void close_output() noexcept final override;
+
+    bool is_output_open() const noexcept final override {
+        return !!out_;
+    }
+
+    //---game_renderer_impl interface
+    void add_task(string_view const id) {
+        current_.push_back({id, duration_t {}, renderer2d::draw_stats {}});
+        starts_.push_back(timepoint_t {});
+        last_.resize(current_.size());
+    }
+
+    void begin_task(size_t const i, renderer2d const& r) noexcept {
+        starts_[i]         = clock_t::now();
+        current_[i].stats = r.stats();
+    }
+
+    void end_task(size_t const i, renderer2d const& r) noexcept {
+        auto& p = current_[i];
+        p.cpu_time = clock_t::now() - starts_[i];
+        p.stats    = r.stats() - p.stats;
+    }
+
+    void end_frame() noexcept;
+private:
+    std::chrono::microseconds::rep to_us_(duration_t const d) const noexcept {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(d).count();
+    }
+
+    void write_csv_() noexcept;
+    void write_chrome_trace_() noexcept;
+
+    timepoint_t epoch_;
+    int64_t     frame_ {};
+
+    std::vector<task_profile> current_;
+    std::vector<task_profile> last_;
+    std::vector<timepoint_t>  starts_;  //!< by task for the current frame
+
+    std::FILE*    out_        {};
+    output_format out_format_ {output_format::csv};
+    bool          out_first_  {true};
+};
+
+bool frame_profiler_impl::open_output(
+    char const*   const filename
+  , output_format const format
+) {
+    close_output();
+
+    out_ = std::fopen(filename, "w");
+    if (!out_) {
+        return false;
+    }
+
+    out_format_ = format;
+    out_first_  = true;
+
+    switch (format) {
+    case output_format::csv:
+        std::fprintf(out_, "frame,task,start_us,cpu_us,draw_tiles_calls,tiles"
+                           ",rects_filled,rects_drawn,color_mod_switches\n");
+        break;
+    case output_format::chrome_trace:
+        std::fprintf(out_, "[\n");
+        break;
+    default:
+        BK_ASSERT(false);
+        break;
+    }
+
+    return true;
+}
+
+void frame_profiler_impl::close_output() noexcept {
+    if (!out_) {
+        return;
+    }
+
+    if (out_format_ == output_format::chrome_trace) {
+        std::fprintf(out_, "\n]\n");
+    }
+
+    std::fclose(out_);
+    out_ = nullptr;
+}
+
+void frame_profiler_impl::end_frame() noexcept {
+    if (out_) {
+        switch (out_format_) {
+        case output_format::csv:          write_csv_();          break;
+        case output_format::chrome_trace: write_chrome_trace_(); break;
+        default:                                                 break;
+        }
+    }
+
+    std::copy(current_.begin(), current_.end(), last_.begin());
+    ++frame_;
+}
+
+void frame_profiler_impl::write_csv_() noexcept {
+    for (size_t i = 0; i < current_.size(); ++i) {
+        auto const& p = current_[i];
+
+        std::fprintf(out_
+          , "%" PRId64 ",%.*s,%" PRId64 ",%" PRId64
+            ",%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64 "\n"
+          , frame_
+          , static_cast<int>(p.id.size()), p.id.data()
+          , to_us_(starts_[i] - epoch_)
+          , to_us_(p.cpu_time)
+          , p.stats.draw_tiles_calls
+          , p.stats.tiles
+          , p.stats.rects_filled
+          , p.stats.rects_drawn
+          , p.stats.color_mod_switches);
+    }
+}
+
+void frame_profiler_impl::write_chrome_trace_() noexcept {
+    for (size_t i = 0; i < current_.size(); ++i) {
+        auto const& p = current_[i];
+
+        std::fprintf(out_
+          , "%s{\"name\":\"%.*s\",\"cat\":\"render\",\"ph\":\"X\""
+            ",\"pid\":0,\"tid\":0,\"ts\":%" PRId64 ",\"dur\":%" PRId64
+            ",\"args\":{\"frame\":%" PRId64 ",\"draw_tiles_calls\":%" PRId64
+            ",\"tiles\":%" PRId64 ",\"rects_filled\":%" PRId64
+            ",\"rects_drawn\":%" PRId64 ",\"color_mod_switches\":%" PRId64 "}}"
+          , out_first_ ? "" : ",\n"
+          , static_cast<int>(p.id.size()), p.id.data()
+          , to_us_(starts_[i] - epoch_)
+          , to_us_(p.cpu_time)
+          , frame_
+          , p.stats.draw_tiles_calls
+          , p.stats.tiles
+          , p.stats.rects_filled
+          , p.stats.rects_drawn
+          , p.stats.color_mod_switches);
+
+        out_first_ = false;
+    }
+}
+
+//=====--------------------------------------------------------------------=====
+//=====--------------------------------------------------------------------=====
+profiler_renderer::~profiler_renderer() = default;
+
+class profiler_renderer_impl final : public profiler_renderer {
+public:
+    profiler_renderer_impl(text_renderer& tr, frame_profiler const& profiler)
+      : trender_  {tr}
+      , profiler_ {profiler}
+    {
+        text_.visible(false);
+    }
+
+    //---render_task interface
+    void render(duration_t delta, renderer2d& r, view const& v) final override;
+
+    bool is_dirty() const noexcept final override {
+        return dirty_
+            || (is_visible() && clock_t::now() - last_update_ >= update_rate());
+    }
+
+    //---profiler_renderer interface
+    bool is_visible() const noexcept final override {
+        return text_.is_visible();
+    }
+
+    bool visible(bool const state) noexcept final override {
+        last_update_ = timepoint_t {};
+        dirty_       = true;
+        return text_.visible(state);
+    }
+private:
+    //! the text is only laid out again at this rate to keep it readable (and
+    //! to keep the overlay itself cheap).
+    static duration_t update_rate() noexcept {
+        return std::chrono::milliseconds {250};
+    }
+
+    void update_text_();
+
+    text_renderer&        trender_;
+    frame_profiler const& profiler_;
+    text_layout           text_;
+    timepoint_t           last_update_ {};
+    bool                  dirty_ = false;
+};
+
+std::unique_ptr<profiler_renderer>
+make_profiler_renderer(text_renderer& tr, frame_profiler const& profiler) {
+    return std::make_unique<profiler_renderer_impl>(tr, profiler);
+}
+
+void profiler_renderer_impl::update_text_() {
+    std::string text;
+
+    static_string_buffer<128> buffer;
+
+    buffer.append("%-12s %8s %6s %7s %6s %6s %6s\n"
+      , "task", "cpu (us)", "calls", "tiles", "fill", "draw", "cmod");
+    text.append(buffer.data(), buffer.size());
+
+    renderer2d::draw_stats total {};
+    duration_t             total_time {};
+
+    auto const append_row = [&](string_view const id, duration_t const t
+                              , renderer2d::draw_stats const& s) {
+        using namespace std::chrono;
+        auto const us = duration_cast<microseconds>(t).count();
+
+        buffer.clear();
+        buffer.append("%-12.*s %8" PRId64 " %6" PRId64 " %7" PRId64
+                      " %6" PRId64 " %6" PRId64 " %6" PRId64 "\n"
+          , static_cast<int>(std::min(id.size(), size_t {12})), id.data()
+          , us, s.draw_tiles_calls, s.tiles, s.rects_filled, s.rects_drawn
+          , s.color_mod_switches);
+
+        text.append(buffer.data(), buffer.size());
+    };
+
+    for (auto const& p : profiler_) {
+        append_row(p.id, p.cpu_time, p.stats);
+
+        total_time               += p.cpu_time;
+        total.draw_tiles_calls   += p.stats.draw_tiles_calls;
+        total.tiles              += p.stats.tiles;
+        total.rects_filled       += p.stats.rects_filled;
+        total.rects_drawn        += p.stats.rects_drawn;
+        total.color_mod_switches += p.stats.color_mod_switches;
+    }
+
+    append_row("total", total_time, total);
+
+    text_.layout(trender_, std::move(text));
+}
+
+void profiler_renderer_impl::render(duration_t, renderer2d& r, view const&) {
+    dirty_ = false;
+
+    if (!is_visible()) {
+        return;
+    }
+
+    auto const now = clock_t::now();
+    if (now - last_update_ >= update_rate()) {
+        last_update_ = now;
+        update_text_();
+    }
+
+    auto const border_w = 2;
+    auto const client   = r.get_client_rect();
+    auto const text_r   = text_.extent();
+
+    // top right corner of the window
+    auto const v = vec2i32 {
+        value_cast(client.x1 - text_r.x1) - border_w * 2
+      , value_cast(client.y0 - text_r.y0) + border_w * 2};
+
+    auto const trans = r.transform({1.0f, 1.0f, 0.0f, 0.0f});
+
+    r.fill_rect(text_r + v, 0xDF222222u);
+    r.draw_rect(grow_rect(text_r, border_w) + v, border_w, 0xDF66DDDDu);
+
+    render_text(r, trender_, text_, v);
 }
 
 //=====--------------------------------------------------------------------=====
@@ -771,13 +1448,24 @@ game_renderer::~game_renderer() = default;
 
 class game_renderer_impl final : public game_renderer {
 public:
-    game_renderer_impl(system& os, text_renderer& trender)
-      : os_      {os}
-      , trender_ {trender}
+    game_renderer_impl(std::unique_ptr<renderer2d> renderer, text_renderer& trender)
+      : trender_  {trender}
+      , renderer_ {std::move(renderer)}
     {
+        BK_ASSERT(!!renderer_);
+    }
+
+    bool render(duration_t delta, view const& v) const noexcept final override;
+
+    bool is_dirty() const noexcept final override {
+        return invalidated_
+            || std::any_of(begin(tasks_), end(tasks_), [](task_info const& t) noexcept {
+                   return t.task->is_dirty(); });
     }
 
-    void render(duration_t delta, view const& v) const noexcept final override;
+    void invalidate() noexcept final override {
+        invalidated_ = true;
+    }
 
     void add_task_generic(
         string_view const id
@@ -786,6 +1474,15 @@ public:
     ) final override {
         BK_ASSERT(!!task && !id.empty());
         tasks_.push_back({std::move(task), id, zorder});
+        profiler_.add_task(id);
+    }
+
+    frame_profiler& profiler() noexcept final override {
+        return profiler_;
+    }
+
+    frame_profiler const& profiler() const noexcept final override {
+        return profiler_;
     }
 private:
     struct task_info {
@@ -794,29 +1491,52 @@ private:
         int zorder;
     };
 
-    system&        os_;
     text_renderer& trender_;
 
-    std::unique_ptr<renderer2d> renderer_ = make_renderer(os_);
+    std::unique_ptr<renderer2d> renderer_;
     std::vector<task_info> tasks_;
+
+    mutable frame_profiler_impl profiler_;
+
+    mutable uint32_t last_view_version_ {0};
+    mutable bool     invalidated_       {true};
 };
 
 std::unique_ptr<game_renderer> make_game_renderer(system& os, text_renderer& trender) {
-    return std::make_unique<game_renderer_impl>(os, trender);
+    return make_game_renderer(make_renderer(os), trender);
+}
+
+std::unique_ptr<game_renderer> make_game_renderer(
+    std::unique_ptr<renderer2d> renderer
+  , text_renderer&              trender
+) {
+    return std::make_unique<game_renderer_impl>(std::move(renderer), trender);
 }
 
-void game_renderer_impl::render(duration_t const delta, view const& v) const noexcept {
+bool game_renderer_impl::render(duration_t const delta, view const& v) const noexcept {
+    if (v.version() == last_view_version_ && !is_dirty()) {
+        return false;
+    }
+
+    invalidated_       = false;
+    last_view_version_ = v.version();
+
     auto& r = *renderer_;
 
     r.render_clear();
     r.transform();
     r.draw_background();
 
-    for (auto const& t : tasks_) {
-        t.task->render(delta, r, v);
+    for (size_t i = 0; i < tasks_.size(); ++i) {
+        profiler_.begin_task(i, r);
+        tasks_[i].task->render(delta, r, v);
+        profiler_.end_task(i, r);
     }
 
     r.render_present();
+    profiler_.end_frame();
+
+    return true;
 }
 
 } //namespace boken
@@ -29,20 +29,20 @@ public:
 
     template <typename T>
     point2f world_to_window(point2<T> const p) const noexcept {
-        return {scale_x * value_cast_unsafe<float>(p.x) + x_off
-              , scale_y * value_cast_unsafe<float>(p.y) + y_off};
+        return {scale_x_ * value_cast_unsafe<float>(p.x) + x_off_
+              , scale_y_ * value_cast_unsafe<float>(p.y) + y_off_};
     }
 
     template <typename T>
     vec2f world_to_window(vec2<T> const v) const noexcept {
-        return {scale_x * value_cast_unsafe<float>(v.x)
-              , scale_y * value_cast_unsafe<float>(v.y)};
+        return {scale_x_ * value_cast_unsafe<float>(v.x)
+              , scale_y_ * value_cast_unsafe<float>(v.y)};
     }
 
     template <typename T>
     point2f window_to_world(point2<T> const p) const noexcept {
-        return {(1.0f / scale_x) * value_cast_unsafe<float>(p.x) - (x_off / scale_x)
-              , (1.0f / scale_y) * value_cast_unsafe<float>(p.y) - (y_off / scale_y)};
+        return {(1.0f / scale_x_) * value_cast_unsafe<float>(p.x) - (x_off_ / scale_x_)
+              , (1.0f / scale_y_) * value_cast_unsafe<float>(p.y) - (y_off_ / scale_y_)};
     }
 
     template <typename T>
@@ -63,8 +63,8 @@ public:
 
     template <typename T>
     vec2f window_to_world(vec2<T> const v) const noexcept {
-        return {(1.0f / scale_x) * value_cast_unsafe<float>(v.x)
-              , (1.0f / scale_y) * value_cast_unsafe<float>(v.y)};
+        return {(1.0f / scale_x_) * value_cast_unsafe<float>(v.x)
+              , (1.0f / scale_y_) * value_cast_unsafe<float>(v.y)};
     }
 
     template <typename T>
@@ -88,10 +88,25 @@ public:
               , static_cast<float>((wh * 0.5) - th * (py + 0.5))};
     }
 
-    float x_off   = 0.0f;
-    float y_off   = 0.0f;
-    float scale_x = 1.0f;
-    float scale_y = 1.0f;
+    float x_off()   const noexcept { return x_off_; }
+    float y_off()   const noexcept { return y_off_; }
+    float scale_x() const noexcept { return scale_x_; }
+    float scale_y() const noexcept { return scale_y_; }
+
+    void set_offset(float x, float y) noexcept;
+    void set_scale(float sx, float sy) noexcept;
+
+    //! Changed by every call to a setter; two views with the same version
+    //! have the same transformation, so this can be compared instead of the
+    //! values themselves.
+    uint32_t version() const noexcept { return version_; }
+private:
+    float x_off_   = 0.0f;
+    float y_off_   = 0.0f;
+    float scale_x_ = 1.0f;
+    float scale_y_ = 1.0f;
+
+    uint32_t version_ = 0;
 };
 
 struct read_only_pointer_t {
@@ -110,18 +125,31 @@ struct read_only_pointer_t {
     {
     }
 
+    //! a pointer to the sub-object at @p offset within each element of the
+    //! range [beg, end).
     template <typename T>
-    explicit read_only_pointer_t(std::vector<T> const& v, size_t const offset = 0, size_t const stride = sizeof(T)) noexcept
+    read_only_pointer_t(
+        T const* const beg
+      , T const* const end
+      , size_t   const offset
+      , size_t   const stride
+    ) noexcept
       : read_only_pointer_t {
             reinterpret_cast<T const*>(
                 reinterpret_cast<char const*>(
-                    reinterpret_cast<void const*>(v.data())
+                    reinterpret_cast<void const*>(beg)
                 ) + offset)
-          , v.data() + v.size()
+          , end
           , stride}
     {
     }
 
+    template <typename T, typename Allocator>
+    explicit read_only_pointer_t(std::vector<T, Allocator> const& v, size_t const offset = 0, size_t const stride = sizeof(T)) noexcept
+      : read_only_pointer_t {v.data(), v.data() + v.size(), offset, stride}
+    {
+    }
+
     read_only_pointer_t& operator++() noexcept {
         ptr = (ptr == last) ? ptr
           : reinterpret_cast<char const*>(ptr) + element_stride;
@@ -179,6 +207,17 @@ public:
         float trans_y;
     };
 
+    //! Running totals of the work submitted to the renderer since it was
+    //! created; the work done over some interval is the difference of two
+    //! snapshots.
+    struct draw_stats {
+        int64_t draw_tiles_calls;   //!< calls to draw_tiles
+        int64_t tiles;              //!< tiles submitted to draw_tiles
+        int64_t rects_filled;       //!< rects submitted to fill_rect(s)
+        int64_t rects_drawn;        //!< rects submitted to draw_rect(s)
+        int64_t color_mod_switches; //!< changes of the texture color mod
+    };
+
     template <typename T>
     class undo_t {
     public:
@@ -235,8 +274,20 @@ public:
         }
     };
 
-    using undo_transform = undo_t<undo_transform_action>;
-    using undo_clip_rect = undo_t<undo_clip_rect_action>;
+    struct undo_render_target_action {
+        uint32_t target;
+
+        void operator()(renderer2d& r) {
+            r.set_render_target(target);
+        }
+    };
+
+    using undo_transform     = undo_t<undo_transform_action>;
+    using undo_clip_rect     = undo_t<undo_clip_rect_action>;
+    using undo_render_target = undo_t<undo_render_target_action>;
+
+    //! the render target id referring to the window itself.
+    static constexpr uint32_t target_window = 0xFFFFFFFFu;
 
     virtual ~renderer2d();
 
@@ -250,9 +301,22 @@ public:
     virtual undo_transform transform(transform_t t) = 0;
     virtual void transform() = 0;
 
+    //! create a transparent texture of the given size (in pixels) which can be
+    //! used both as a render target and as the texture_id for draw_tiles.
+    //! @returns the texture id of the new render target.
+    virtual uint32_t create_render_target(sizei32x w, sizei32y h) = 0;
+
+    virtual void set_render_target(uint32_t id) = 0;
+    virtual undo_render_target render_target(uint32_t id) = 0;
+    virtual void render_target() = 0;
+
     virtual void render_clear()   = 0;
     virtual void render_present() = 0;
 
+    //! set the pixels in @p r to transparent black, ignoring blending; e.g. to
+    //! reuse part of a render target.
+    virtual void clear_rect(recti32 r) = 0;
+
     virtual void fill_rect(recti32 r, uint32_t color) = 0;
 
     virtual void fill_rects(
@@ -281,8 +345,21 @@ public:
 
     virtual void draw_tiles(tile_params_uniform  const& params) = 0;
     virtual void draw_tiles(tile_params_variable const& params) = 0;
+
+    virtual draw_stats stats() const noexcept = 0;
 };
 
+inline renderer2d::draw_stats operator-(
+    renderer2d::draw_stats const& a
+  , renderer2d::draw_stats const& b
+) noexcept {
+    return {a.draw_tiles_calls   - b.draw_tiles_calls
+          , a.tiles              - b.tiles
+          , a.rects_filled       - b.rects_filled
+          , a.rects_drawn        - b.rects_drawn
+          , a.color_mod_switches - b.color_mod_switches};
+}
+
 std::unique_ptr<renderer2d> make_renderer(system& sys);
 
 //=====--------------------------------------------------------------------=====
@@ -295,6 +372,10 @@ public:
 
     virtual ~render_task();
     virtual void render(duration_t delta, renderer2d& r, view const& v) = 0;
+
+    //! @returns true if rendering would produce something different from the
+    //! last call to render (given the same view).
+    virtual bool is_dirty() const noexcept = 0;
 };
 
 //=====--------------------------------------------------------------------=====
@@ -382,6 +463,10 @@ public:
     virtual void update_map_data() = 0;
     virtual void update_map_data(const_sub_region_range<tile_id> sub_region) = 0;
 
+    //! Redraw the cached base layer in full the next time the map is rendered;
+    //! required after the contents of render targets have been lost.
+    virtual void reset_render_targets() noexcept = 0;
+
     virtual void update_data(update_t<entity_id> const* first
                            , update_t<entity_id> const* last) = 0;
 
@@ -392,6 +477,53 @@ public:
 
 std::unique_ptr<map_renderer> make_map_renderer();
 
+//=====--------------------------------------------------------------------=====
+// Records the cpu time and draw_stats of each render_task for every frame.
+//=====--------------------------------------------------------------------=====
+class frame_profiler {
+public:
+    using duration_t = render_task::duration_t;
+
+    enum class output_format {
+        csv, chrome_trace
+    };
+
+    struct task_profile {
+        string_view            id;
+        duration_t             cpu_time;
+        renderer2d::draw_stats stats;
+    };
+
+    virtual ~frame_profiler();
+
+    //! the number of frames profiled so far.
+    virtual int64_t frame_count() const noexcept = 0;
+
+    //! the profile of each task, in render order, for the last complete frame.
+    virtual task_profile const* begin() const noexcept = 0;
+    virtual task_profile const* end() const noexcept = 0;
+
+    //! stream the profile of every subsequent frame to @p filename.
+    //! @returns false if the file couldn't be opened.
+    virtual bool open_output(char const* filename, output_format format) = 0;
+    virtual void close_output() noexcept = 0;
+    virtual bool is_output_open() const noexcept = 0;
+};
+
+//=====--------------------------------------------------------------------=====
+// A debug overlay showing the last frame of a frame_profiler.
+//=====--------------------------------------------------------------------=====
+class profiler_renderer : public render_task {
+public:
+    virtual ~profiler_renderer();
+
+    virtual bool is_visible() const noexcept = 0;
+    virtual bool visible(bool state) noexcept = 0;
+};
+
+std::unique_ptr<profiler_renderer>
+make_profiler_renderer(text_renderer& tr, frame_profiler const& profiler);
+
 //=====--------------------------------------------------------------------=====
 // Responsible for rendering all the various game and ui objects.
 //=====--------------------------------------------------------------------=====
@@ -401,7 +533,18 @@ public:
 
     virtual ~game_renderer();
 
-    virtual void render(duration_t delta, view const& v) const noexcept = 0;
+    //! Render a frame if any task is dirty, the view has changed, or the
+    //! renderer has been invalidated since the last frame.
+    //! @returns true if a frame was rendered.
+    virtual bool render(duration_t delta, view const& v) const noexcept = 0;
+
+    //! @returns true if any task is dirty or the renderer has been invalidated;
+    //! that is, whether the next call to render will produce a new frame
+    //! regardless of the view.
+    virtual bool is_dirty() const noexcept = 0;
+
+    //! force the next frame to be rendered; e.g. after the window is exposed.
+    virtual void invalidate() noexcept = 0;
 
     template <typename T>
     T& add_task(
@@ -418,9 +561,17 @@ public:
     virtual void add_task_generic(string_view id
                                 , std::unique_ptr<render_task> task
                                 , int zorder) = 0;
+
+    virtual frame_profiler&       profiler()       noexcept = 0;
+    virtual frame_profiler const& profiler() const noexcept = 0;
 };
 
 std::unique_ptr<game_renderer>
 make_game_renderer(system& os, text_renderer& trender);
 
+//! as above, but rendering with the given @p renderer; e.g. one created by
+//! make_software_renderer.
+std::unique_ptr<game_renderer>
+make_game_renderer(std::unique_ptr<renderer2d> renderer, text_renderer& trender);
+
 } //namespace boken
@@ -0,0 +1,857 @@
+#include "render_software.hpp"
+#include "math.hpp"             // for ceil_as, round_as
+#include "memory_stats.hpp"
+
+#include <bkassert/assert.hpp>
+
+#include <algorithm>
+#include <array>
+#include <future>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>
+
+namespace boken {
+
+namespace {
+
+//! a 0xAABBGGRR image; used for the textures and the framebuffer alike.
+struct image_t {
+    int32_t w {};
+    int32_t h {};
+    tracked_vector<uint32_t, memory_tag::render> pixels;
+
+    image_t() = default;
+
+    image_t(int32_t const width, int32_t const height, uint32_t const color)
+      : w {width}
+      , h {height}
+      , pixels(static_cast<size_t>(width) * static_cast<size_t>(height), color)
+    {
+        BK_ASSERT(width >= 0 && height >= 0);
+    }
+
+    bool empty() const noexcept { return pixels.empty(); }
+
+    uint32_t& at(int32_t const x, int32_t const y) noexcept {
+        return pixels[static_cast<size_t>(x + y * w)];
+    }
+
+    uint32_t at(int32_t const x, int32_t const y) const noexcept {
+        return pixels[static_cast<size_t>(x + y * w)];
+    }
+};
+
+//===------------------------------------------------------------------------===
+//                              file io
+//===------------------------------------------------------------------------===
+struct file_deleter {
+    void operator()(std::FILE* const f) const noexcept {
+        std::fclose(f);
+    }
+};
+
+using unique_file = std::unique_ptr<std::FILE, file_deleter>;
+
+std::vector<uint8_t> read_file(char const* const filename) {
+    std::vector<uint8_t> result;
+
+    auto const f = unique_file {std::fopen(filename, "rb")};
+    if (!f) {
+        return result;
+    }
+
+    std::array<uint8_t, 4096> buffer;
+    for (size_t n = 0; (n = std::fread(buffer.data(), 1, buffer.size(), f.get())) > 0; ) {
+        result.insert(end(result), buffer.data(), buffer.data() + n);
+    }
+
+    return result;
+}
+
+bool write_file(char const* const filename, uint8_t const* const data, size_t const size) {
+    auto f = unique_file {std::fopen(filename, "wb")};
+    if (!f) {
+        return false;
+    }
+
+    auto const written = std::fwrite(data, 1, size, f.get());
+    return (written == size) && (std::fclose(f.release()) == 0);
+}
+
+uint32_t read_le(std::vector<uint8_t> const& data, size_t const offset, size_t const bytes) noexcept {
+    uint32_t result = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        result |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+    }
+
+    return result;
+}
+
+//! @returns the value of the channel selected by @p mask scaled to 8 bits.
+uint32_t extract_channel(uint32_t const value, uint32_t const mask) noexcept {
+    if (!mask) {
+        return 0xFFu;
+    }
+
+    auto shift = 0u;
+    while (!((mask >> shift) & 1u)) {
+        ++shift;
+    }
+
+    auto const max = mask >> shift;
+    return (((value & mask) >> shift) * 0xFFu + max / 2) / max;
+}
+
+//! Load an uncompressed 8, 24 or 32 bit BMP image.
+//! @returns an empty image on failure.
+image_t load_bmp(char const* const filename) {
+    auto const data = read_file(filename);
+
+    constexpr size_t file_header_size = 14;
+
+    if (data.size() < file_header_size + 40
+     || data[0] != 'B' || data[1] != 'M'
+    ) {
+        return {};
+    }
+
+    auto const pixel_offset = read_le(data, 10, 4);
+    auto const dib_size     = read_le(data, 14, 4);
+    auto const width        = static_cast<int32_t>(read_le(data, 18, 4));
+    auto const raw_height   = static_cast<int32_t>(read_le(data, 22, 4));
+    auto const bpp          = read_le(data, 28, 2);
+    auto const compression  = read_le(data, 30, 4);
+    auto const colors_used  = read_le(data, 46, 4);
+
+    auto const bottom_up = raw_height > 0;
+    auto const height    = bottom_up ? raw_height : -raw_height;
+
+    constexpr uint32_t bi_rgb       = 0;
+    constexpr uint32_t bi_bitfields = 3;
+
+    if (width <= 0 || height <= 0
+     || (compression != bi_rgb && compression != bi_bitfields)
+     || (bpp != 8 && bpp != 24 && bpp != 32)
+    ) {
+        return {};
+    }
+
+    // channel masks for 32 bit images; bitfields follow a 40 byte header
+    auto r_mask = 0x00FF0000u;
+    auto g_mask = 0x0000FF00u;
+    auto b_mask = 0x000000FFu;
+    auto a_mask = 0x00000000u;
+
+    if (compression == bi_bitfields) {
+        auto const off = file_header_size + 40;
+        if (data.size() < off + 12) {
+            return {};
+        }
+
+        r_mask = read_le(data, off + 0, 4);
+        g_mask = read_le(data, off + 4, 4);
+        b_mask = read_le(data, off + 8, 4);
+        a_mask = (dib_size >= 56 && data.size() >= off + 16)
+          ? read_le(data, off + 12, 4)
+          : 0u;
+    }
+
+    auto const palette_offset = file_header_size + dib_size;
+    auto const palette_size   = (colors_used ? colors_used : 256u);
+
+    auto const stride = ((static_cast<size_t>(width) * bpp + 31u) / 32u) * 4u;
+    if (data.size() < pixel_offset + stride * static_cast<size_t>(height)
+     || (bpp == 8 && data.size() < palette_offset + palette_size * 4)
+    ) {
+        return {};
+    }
+
+    auto const bgr = [&](size_t const off) noexcept {
+        return (0xFFu                        << 24)
+             | (static_cast<uint32_t>(data[off + 0]) << 16)
+             | (static_cast<uint32_t>(data[off + 1]) <<  8)
+             | (static_cast<uint32_t>(data[off + 2]) <<  0);
+    };
+
+    image_t result {width, height, 0};
+
+    for (int32_t y = 0; y < height; ++y) {
+        auto const row = pixel_offset + stride
+            * static_cast<size_t>(bottom_up ? (height - 1 - y) : y);
+
+        for (int32_t x = 0; x < width; ++x) {
+            auto const i = static_cast<size_t>(x);
+
+            switch (bpp) {
+            case 8 : {
+                auto const index = std::min<uint32_t>(data[row + i], palette_size - 1);
+                result.at(x, y) = bgr(palette_offset + index * 4);
+                break;
+            }
+            case 24 :
+                result.at(x, y) = bgr(row + i * 3);
+                break;
+            case 32 : {
+                auto const v = read_le(data, row + i * 4, 4);
+                result.at(x, y) = (extract_channel(v, a_mask) << 24)
+                                | (extract_channel(v, b_mask) << 16)
+                                | (extract_channel(v, g_mask) <<  8)
+                                | (extract_channel(v, r_mask) <<  0);
+                break;
+            }
+            default :
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+//! A checkered stand-in for a texture which couldn't be loaded.
+image_t make_placeholder(int32_t const w, int32_t const h) {
+    image_t result {w, h, 0xFFFFFFFFu};
+
+    for (int32_t y = 0; y < h; ++y) {
+        for (int32_t x = 0; x < w; ++x) {
+            if (((x / 9) + (y / 9)) % 2) {
+                result.at(x, y) = 0xFFC0C0C0u;
+            }
+        }
+    }
+
+    return result;
+}
+
+image_t load_texture(char const* const filename, int32_t const w, int32_t const h) {
+    auto result = load_bmp(filename);
+    if (result.empty()) {
+        std::printf("warning: couldn't load \"%s\"; using a placeholder.\n"
+                  , filename);
+        return make_placeholder(w, h);
+    }
+
+    return result;
+}
+
+//! As per create_font_texture for SDL: black is transparent.
+image_t make_font_texture(image_t result) {
+
+    for (auto& p : result.pixels) {
+        auto const color = p & 0x00FFFFFFu;
+        p = color | (color == 0 ? 0u : 0xFF000000u);
+    }
+
+    return result;
+}
+
+//===------------------------------------------------------------------------===
+//                             image output
+//===------------------------------------------------------------------------===
+class crc32_table {
+public:
+    crc32_table() noexcept {
+        for (uint32_t i = 0; i < 256; ++i) {
+            auto c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1u) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            table_[i] = c;
+        }
+    }
+
+    uint32_t operator()(uint8_t const* const first, uint8_t const* const last) const noexcept {
+        auto c = 0xFFFFFFFFu;
+        for (auto it = first; it != last; ++it) {
+            c = table_[(c ^ *it) & 0xFFu] ^ (c >> 8);
+        }
+
+        return c ^ 0xFFFFFFFFu;
+    }
+private:
+    std::array<uint32_t, 256> table_;
+};
+
+void append_be32(std::vector<uint8_t>& out, uint32_t const n) {
+    out.push_back(static_cast<uint8_t>((n >> 24) & 0xFFu));
+    out.push_back(static_cast<uint8_t>((n >> 16) & 0xFFu));
+    out.push_back(static_cast<uint8_t>((n >>  8) & 0xFFu));
+    out.push_back(static_cast<uint8_t>((n >>  0) & 0xFFu));
+}
+
+void append_png_chunk(
+    std::vector<uint8_t>&       out
+  , crc32_table const&          crc
+  , char const* const           type
+  , std::vector<uint8_t> const& data
+) {
+    append_be32(out, static_cast<uint32_t>(data.size()));
+
+    auto const first = out.size();
+    out.insert(end(out), type, type + 4);
+    out.insert(end(out), begin(data), end(data));
+
+    append_be32(out, crc(out.data() + first, out.data() + out.size()));
+}
+
+//! Encode @p img as a PNG using uncompressed (stored) deflate blocks; this
+//! keeps the output dependency free at the cost of size.
+std::vector<uint8_t> encode_png(image_t const& img) {
+    // the raw scanlines: a filter type byte (none) followed by RGBA pixels
+    std::vector<uint8_t> raw;
+    raw.reserve(static_cast<size_t>(img.h) * (1 + static_cast<size_t>(img.w) * 4));
+
+    for (int32_t y = 0; y < img.h; ++y) {
+        raw.push_back(0);
+        for (int32_t x = 0; x < img.w; ++x) {
+            auto const p = img.at(x, y);
+            raw.push_back(static_cast<uint8_t>((p >>  0) & 0xFFu));
+            raw.push_back(static_cast<uint8_t>((p >>  8) & 0xFFu));
+            raw.push_back(static_cast<uint8_t>((p >> 16) & 0xFFu));
+            raw.push_back(static_cast<uint8_t>((p >> 24) & 0xFFu));
+        }
+    }
+
+    // zlib stream
+    std::vector<uint8_t> idat {0x78, 0x01};
+
+    constexpr size_t max_block = 0xFFFF;
+    for (size_t i = 0; i < raw.size() || i == 0; i += max_block) {
+        auto const n     = std::min(max_block, raw.size() - i);
+        auto const final = (i + n >= raw.size()) ? 1u : 0u;
+        auto const len   = static_cast<uint16_t>(n);
+        auto const nlen  = static_cast<uint16_t>(~len);
+
+        idat.push_back(static_cast<uint8_t>(final));
+        idat.push_back(static_cast<uint8_t>(len  & 0xFFu));
+        idat.push_back(static_cast<uint8_t>(len  >> 8));
+        idat.push_back(static_cast<uint8_t>(nlen & 0xFFu));
+        idat.push_back(static_cast<uint8_t>(nlen >> 8));
+        idat.insert(end(idat), raw.data() + i, raw.data() + i + n);
+
+        if (final) {
+            break;
+        }
+    }
+
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (auto const c : raw) {
+        a = (a + c) % 65521u;
+        b = (b + a) % 65521u;
+    }
+
+    append_be32(idat, (b << 16) | a);
+
+    std::vector<uint8_t> ihdr;
+    append_be32(ihdr, static_cast<uint32_t>(img.w));
+    append_be32(ihdr, static_cast<uint32_t>(img.h));
+    ihdr.push_back(8); // bit depth
+    ihdr.push_back(6); // RGBA
+    ihdr.push_back(0); // deflate
+    ihdr.push_back(0); // adaptive filtering
+    ihdr.push_back(0); // no interlace
+
+    crc32_table const crc;
+
+    std::vector<uint8_t> result {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    append_png_chunk(result, crc, "IHDR", ihdr);
+    append_png_chunk(result, crc, "IDAT", idat);
+    append_png_chunk(result, crc, "IEND", {});
+
+    return result;
+}
+
+std::vector<uint8_t> encode_ppm(image_t const& img) {
+    char header[64];
+    auto const n = std::snprintf(header, sizeof(header), "P6\n%d %d\n255\n", img.w, img.h);
+    BK_ASSERT(n > 0 && static_cast<size_t>(n) < sizeof(header));
+
+    std::vector<uint8_t> result (header, header + n);
+    result.reserve(result.size() + img.pixels.size() * 3);
+
+    for (auto const p : img.pixels) {
+        result.push_back(static_cast<uint8_t>((p >>  0) & 0xFFu));
+        result.push_back(static_cast<uint8_t>((p >>  8) & 0xFFu));
+        result.push_back(static_cast<uint8_t>((p >> 16) & 0xFFu));
+    }
+
+    return result;
+}
+
+//===------------------------------------------------------------------------===
+//                             rasterization
+//===------------------------------------------------------------------------===
+
+//! The color @p src (with alpha) over @p dst; as per SDL_BLENDMODE_BLEND.
+inline uint32_t blend(uint32_t const dst, uint32_t const src) noexcept {
+    auto const a = (src >> 24) & 0xFFu;
+    if (a == 0xFFu) {
+        return src;
+    } else if (a == 0) {
+        return dst;
+    }
+
+    auto const mix = [&](uint32_t const shift) noexcept {
+        auto const s = (src >> shift) & 0xFFu;
+        auto const d = (dst >> shift) & 0xFFu;
+        return ((s * a + d * (0xFFu - a) + 0x7Fu) / 0xFFu) << shift;
+    };
+
+    auto const da = (dst >> 24) & 0xFFu;
+    auto const ra = a + (da * (0xFFu - a) + 0x7Fu) / 0xFFu;
+
+    return (ra << 24) | mix(16) | mix(8) | mix(0);
+}
+
+//! The texel @p t modulated by the color @p c; as per SDL's color mod the
+//! alpha of the texel is left unchanged.
+inline uint32_t modulate(uint32_t const t, uint32_t const c) noexcept {
+    if ((c & 0x00FFFFFFu) == 0x00FFFFFFu) {
+        return t;
+    }
+
+    auto const mul = [&](uint32_t const shift) noexcept {
+        auto const x = (t >> shift) & 0xFFu;
+        auto const y = (c >> shift) & 0xFFu;
+        return ((x * y + 0x7Fu) / 0xFFu) << shift;
+    };
+
+    return (t & 0xFF000000u) | mul(16) | mul(8) | mul(0);
+}
+
+} //namespace
+
+//===------------------------------------------------------------------------===
+//                           software_renderer
+//===------------------------------------------------------------------------===
+software_renderer::~software_renderer() = default;
+
+class software_renderer_impl final : public software_renderer {
+public:
+    software_renderer_impl(sizei32x const w, sizei32y const h)
+      : framebuffer_ {value_cast(w), value_cast(h), 0}
+    {
+        // each atlas is loaded once, concurrently
+        auto const load = [](char const* const filename, int32_t const width, int32_t const height) {
+            return std::async(std::launch::async, load_texture, filename, width, height);
+        };
+
+        auto tiles      = load("./data/tiles.bmp",      288, 288);
+        auto entities   = load("./data/entities.bmp",   468, 306);
+        auto background = load("./data/background.bmp", 64,  64);
+
+        textures_.reserve(8);
+
+        // the same texture ids as the SDL renderer
+        //base
+        textures_.push_back(tiles.get());
+        //entities
+        textures_.push_back(entities.get());
+        //items
+        textures_.push_back(textures_[0]);
+        //font
+        textures_.push_back(make_font_texture(textures_[0]));
+        //background
+        textures_.push_back(background.get());
+    }
+//------------------------------------------------------------------------------
+    void resize(sizei32x const w, sizei32y const h) final override {
+        framebuffer_ = image_t {value_cast(w), value_cast(h), 0};
+    }
+
+    uint32_t const* framebuffer() const noexcept final override {
+        return framebuffer_.pixels.data();
+    }
+
+    int64_t frame_count() const noexcept final override {
+        return frame_count_;
+    }
+
+    bool write_ppm(char const* const filename) const final override {
+        auto const data = encode_ppm(framebuffer_);
+        return write_file(filename, data.data(), data.size());
+    }
+
+    bool write_png(char const* const filename) const final override {
+        auto const data = encode_png(framebuffer_);
+        return write_file(filename, data.data(), data.size());
+    }
+//------------------------------------------------------------------------------
+    recti32 get_client_rect() const final override {
+        return {point2i32 {}, sizei32x {framebuffer_.w}, sizei32y {framebuffer_.h}};
+    }
+
+    void set_clip_rect(recti32 const r) final override {
+        active_clip_rect_ = r;
+        if (target_ == target_window) {
+            clip_rect_ = r;
+        }
+    }
+
+    undo_clip_rect clip_rect(recti32 const r) final override {
+        auto const prev = active_clip_rect_;
+        set_clip_rect(r);
+        return {*this, prev};
+    }
+
+    void clip_rect() final override {
+        active_clip_rect_ = recti32 {};
+        clip_rect_        = recti32 {};
+    }
+
+    void set_transform(transform_t const t) final override {
+        trans_ = t;
+    }
+
+    undo_transform transform(transform_t const t) final override {
+        auto const prev = trans_;
+        set_transform(t);
+        return {*this, prev};
+    }
+
+    void transform() final override {
+        transform({1.0f, 1.0f, 0.0f, 0.0f}).dismiss();
+    }
+
+    uint32_t create_render_target(sizei32x const w, sizei32y const h) final override {
+        textures_.push_back(image_t {value_cast(w), value_cast(h), 0});
+        return static_cast<uint32_t>(textures_.size() - 1);
+    }
+
+    void set_render_target(uint32_t const id) final override {
+        BK_ASSERT(id == target_window || id < textures_.size());
+
+        target_ = id;
+
+        // as per SDL, the clip rect only applies to the window
+        active_clip_rect_ = (id == target_window) ? clip_rect_ : recti32 {};
+    }
+
+    undo_render_target render_target(uint32_t const id) final override {
+        auto const prev = target_;
+        set_render_target(id);
+        return {*this, prev};
+    }
+
+    void render_target() final override {
+        set_render_target(target_window);
+    }
+
+    void render_clear() final override {
+        auto& img = target_image_();
+        std::fill(begin(img.pixels), end(img.pixels), 0xFF007F7Fu);
+    }
+
+    void render_present() final override {
+        ++frame_count_;
+    }
+
+    void clear_rect(recti32 const r) final override {
+        fill_(to_pixels_x_(value_cast(r.x0)), to_pixels_y_(value_cast(r.y0))
+            , to_pixels_x_(value_cast(r.x1)), to_pixels_y_(value_cast(r.y1))
+            , 0u, false);
+    }
+
+    void fill_rect(recti32 const r, uint32_t const color) final override {
+        fill_rects(&r, &r + 1, color);
+    }
+
+    void fill_rects(
+        recti32  const* const r_first, recti32  const* const r_last
+      , uint32_t const* const c_first, uint32_t const* const c_last
+    ) final override {
+        BK_ASSERT(std::distance(r_first, r_last)
+               == std::distance(c_first, c_last));
+
+        stats_.rects_filled += std::distance(r_first, r_last);
+
+        auto c = c_first;
+        for (auto it = r_first; it != r_last; ++it, ++c) {
+            fill_scaled_(*it, *c);
+        }
+    }
+
+    void fill_rects(
+        recti32  const* const r_first, recti32  const* const r_last
+      , uint32_t const color
+    ) final override {
+        stats_.rects_filled += std::distance(r_first, r_last);
+
+        for (auto it = r_first; it != r_last; ++it) {
+            fill_scaled_(*it, color);
+        }
+    }
+
+    void draw_rect(recti32 const r, int32_t const border_size, uint32_t const color) final override {
+        draw_rects(&r, &r + 1, color, border_size);
+    }
+
+    void draw_rects(
+        recti32  const* const r_first, recti32  const* const r_last
+      , uint32_t const color
+      , int32_t  const border_size
+    ) final override {
+        stats_.rects_drawn += std::distance(r_first, r_last);
+
+        for (auto it = r_first; it != r_last; ++it) {
+            draw_rect_(*it, border_size, color);
+        }
+    }
+
+    void draw_rects(
+        recti32  const* const r_first, recti32  const* const r_last
+      , uint32_t const* const c_first, uint32_t const* const c_last
+      , int32_t  const border_size
+    ) final override {
+        BK_ASSERT(std::distance(r_first, r_last)
+               == std::distance(c_first, c_last));
+
+        stats_.rects_drawn += std::distance(r_first, r_last);
+
+        auto c = c_first;
+        for (auto it = r_first; it != r_last; ++it, ++c) {
+            draw_rect_(*it, border_size, *c);
+        }
+    }
+
+    void draw_background() final override {
+        auto const& bg = textures_[4];
+        auto const  w  = bg.w;
+        auto const  h  = bg.h;
+        auto const& fb = target_image_();
+
+        for (int32_t y = 0; y < fb.h; y += h) {
+            for (int32_t x = 0; x < fb.w; x += w) {
+                blit_(bg, 0, 0, w, h, x, y, x + w, y + h, 0xFFFFFFFFu);
+            }
+        }
+    }
+
+    draw_stats stats() const noexcept final override {
+        return stats_;
+    }
+
+    void draw_tiles(tile_params_uniform const& p) final override {
+        auto const w = value_cast(p.tile_w);
+        auto const h = value_cast(p.tile_h);
+
+        BK_ASSERT(w >= 0 && h >= 0);
+
+        draw_tiles_impl(p.texture_id, p.count, p.pos_coords, p.tex_coords
+          , p.colors, [&]() noexcept { return std::make_pair(w, h); });
+    }
+
+    void draw_tiles(tile_params_variable const& p) final override {
+        draw_tiles_impl(p.texture_id, p.count, p.pos_coords, p.tex_coords
+          , p.colors, [p_wh = p.tex_sizes]() mutable noexcept {
+                auto const wh = p_wh.value<point2i16>();
+                ++p_wh;
+                return std::make_pair(int {value_cast(wh.x)}
+                                    , int {value_cast(wh.y)});
+            });
+    }
+private:
+    image_t& target_image_() noexcept {
+        return (target_ == target_window)
+          ? framebuffer_
+          : textures_[target_];
+    }
+
+    //! x in logical coordinates to pixels; as with SDL the scale applies to
+    //! all drawing.
+    int32_t to_pixels_x_(int32_t const x) const noexcept {
+        return round_as<int32_t>(static_cast<float>(x) * trans_.scale_x);
+    }
+
+    int32_t to_pixels_y_(int32_t const y) const noexcept {
+        return round_as<int32_t>(static_cast<float>(y) * trans_.scale_y);
+    }
+
+    //! the area of the target which can be drawn to, in pixels.
+    recti32 clip_bounds_() noexcept {
+        auto const& img    = target_image_();
+        auto const  bounds = recti32 {point2i32 {}, sizei32x {img.w}, sizei32y {img.h}};
+
+        auto const& c = active_clip_rect_;
+        if (c == recti32 {}) {
+            return bounds;
+        }
+
+        return clamp(recti32 {
+            offi32x {to_pixels_x_(value_cast(c.x0))}
+          , offi32y {to_pixels_y_(value_cast(c.y0))}
+          , offi32x {to_pixels_x_(value_cast(c.x1))}
+          , offi32y {to_pixels_y_(value_cast(c.y1))}}, bounds);
+    }
+
+    //! fill the rect @p r given in logical coordinates
+    void fill_scaled_(recti32 const r, uint32_t const color) {
+        fill_(to_pixels_x_(value_cast(r.x0)), to_pixels_y_(value_cast(r.y0))
+            , to_pixels_x_(value_cast(r.x1)), to_pixels_y_(value_cast(r.y1))
+            , color);
+    }
+
+    //! fill the rect [x0, x1) x [y0, y1) given in pixels
+    void fill_(
+        int32_t x0, int32_t y0, int32_t x1, int32_t y1
+      , uint32_t const color
+      , bool     const blended = true
+    ) {
+        auto const clip = clip_bounds_();
+        x0 = std::max(x0, value_cast(clip.x0));
+        y0 = std::max(y0, value_cast(clip.y0));
+        x1 = std::min(x1, value_cast(clip.x1));
+        y1 = std::min(y1, value_cast(clip.y1));
+
+        auto& img = target_image_();
+        for (auto y = y0; y < y1; ++y) {
+            for (auto x = x0; x < x1; ++x) {
+                auto& p = img.at(x, y);
+                p = blended ? blend(p, color) : color;
+            }
+        }
+    }
+
+    //! mirrors sdl_renderer_impl::draw_rects_impl
+    void draw_rect_(recti32 const r, int32_t const border_size, uint32_t const color) {
+        auto const tx = ceil_as<int32_t>(trans_.trans_x / trans_.scale_x);
+        auto const ty = ceil_as<int32_t>(trans_.trans_y / trans_.scale_y);
+
+        auto const w  = border_size;
+        auto const h  = border_size;
+
+        auto const x0 = value_cast(r.x0) + tx;
+        auto const y0 = value_cast(r.y0) + ty;
+        auto const x1 = value_cast(r.x1) + tx;
+        auto const y1 = value_cast(r.y1) + ty;
+
+        recti32 const rects[] {
+            {offi32x {x0},     offi32y {y0},     offi32x {x0 + w}, offi32y {y1}}
+          , {offi32x {x1 - w}, offi32y {y0},     offi32x {x1},     offi32y {y1}}
+          , {offi32x {x0 + w}, offi32y {y0},     offi32x {x1 - w}, offi32y {y0 + h}}
+          , {offi32x {x0 + w}, offi32y {y1 - h}, offi32x {x1 - w}, offi32y {y1}}
+        };
+
+        for (auto const& rect : rects) {
+            fill_scaled_(rect, color);
+        }
+    }
+
+    //! nearest neighbor copy of [sx0, sx1) x [sy0, sy1) of @p src onto
+    //! [dx0, dx1) x [dy0, dy1) (in pixels) of the current target.
+    void blit_(
+        image_t const& src
+      , int32_t const sx0, int32_t const sy0, int32_t const sx1, int32_t const sy1
+      , int32_t const dx0, int32_t const dy0, int32_t const dx1, int32_t const dy1
+      , uint32_t const color
+    ) {
+        auto const sw = sx1 - sx0;
+        auto const sh = sy1 - sy0;
+        auto const dw = dx1 - dx0;
+        auto const dh = dy1 - dy0;
+
+        if (sw <= 0 || sh <= 0 || dw <= 0 || dh <= 0) {
+            return;
+        }
+
+        auto const clip = clip_bounds_();
+        auto const x0 = std::max(dx0, value_cast(clip.x0));
+        auto const y0 = std::max(dy0, value_cast(clip.y0));
+        auto const x1 = std::min(dx1, value_cast(clip.x1));
+        auto const y1 = std::min(dy1, value_cast(clip.y1));
+
+        auto& dst = target_image_();
+        BK_ASSERT(&dst != &src);
+
+        for (auto y = y0; y < y1; ++y) {
+            auto const v = sy0 + ((y - dy0) * sh) / dh;
+            if (v < 0 || v >= src.h) {
+                continue;
+            }
+
+            for (auto x = x0; x < x1; ++x) {
+                auto const u = sx0 + ((x - dx0) * sw) / dw;
+                if (u < 0 || u >= src.w) {
+                    continue;
+                }
+
+                auto& p = dst.at(x, y);
+                p = blend(p, modulate(src.at(u, v), color));
+            }
+        }
+    }
+
+    //! mirrors sdl_renderer_impl::draw_tiles_impl
+    template <typename NextSize>
+    void draw_tiles_impl(
+        uint32_t            const texture_id
+      , int32_t             const count
+      , read_only_pointer_t       p_xy
+      , read_only_pointer_t       p_st
+      , read_only_pointer_t       p_c
+      , NextSize                  next_size
+    ) {
+        BK_ASSERT(count >= 0
+               && texture_id < textures_.size());
+
+        auto const& texture = textures_[texture_id];
+
+        auto const tx = ceil_as<int32_t>(trans_.trans_x / trans_.scale_x);
+        auto const ty = ceil_as<int32_t>(trans_.trans_y / trans_.scale_y);
+
+        ++stats_.draw_tiles_calls;
+        stats_.tiles += count;
+
+        // there is no color mod state as such; count the changes as the SDL
+        // renderer would make them.
+        uint32_t last_color = 0;
+        ++stats_.color_mod_switches;
+
+        auto const n = static_cast<size_t>(count);
+        for (size_t i = 0; i < n; ++i, ++p_xy, ++p_st, ++p_c) {
+            auto const xy    = p_xy.value<point2i16>();
+            auto const st    = p_st.value<point2i16>();
+            auto const wh    = next_size();
+            auto const color = p_c.value<uint32_t>();
+
+            if (color != last_color) {
+                last_color = color;
+                ++stats_.color_mod_switches;
+            }
+
+            auto const x = value_cast(xy.x) + tx;
+            auto const y = value_cast(xy.y) + ty;
+            auto const s = int32_t {value_cast(st.x)};
+            auto const t = int32_t {value_cast(st.y)};
+
+            blit_(texture
+                , s, t, s + wh.first, t + wh.second
+                , to_pixels_x_(x), to_pixels_y_(y)
+                , to_pixels_x_(x + wh.first), to_pixels_y_(y + wh.second)
+                , color);
+        }
+    }
+private:
+    image_t              framebuffer_;
+    std::vector<image_t> textures_;
+
+    transform_t trans_            {1.0f, 1.0f, 0.0f, 0.0f};
+    recti32     clip_rect_        {};
+    recti32     active_clip_rect_ {};
+    uint32_t    target_           {target_window};
+    int64_t     frame_count_      {};
+    draw_stats  stats_            {};
+};
+
+bool decode_texture_atlas(char const* const filename) {
+    return !load_bmp(filename).empty();
+}
+
+std::unique_ptr<software_renderer> make_software_renderer(sizei32x const w, sizei32y const h) {
+    return std::make_unique<software_renderer_impl>(w, h);
+}
+
+} //namespace boken
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "render.hpp"
+
+#include <memory>
+#include <cstdint>
+
+namespace boken {
+
+//=====--------------------------------------------------------------------=====
+// A renderer2d which rasterizes into an in-memory framebuffer; it requires
+// neither a window nor a GPU.
+//
+// Pixels, like every other color, are stored as 0xAABBGGRR. The same texture
+// atlases as the SDL renderer are loaded from ./data; a missing atlas is
+// replaced by a placeholder of the same size so that the renderer is usable on
+// machines without the game data.
+//=====--------------------------------------------------------------------=====
+class software_renderer : public renderer2d {
+public:
+    virtual ~software_renderer();
+
+    virtual void resize(sizei32x w, sizei32y h) = 0;
+
+    //! the framebuffer as rows of get_client_rect().width() pixels.
+    virtual uint32_t const* framebuffer() const noexcept = 0;
+
+    //! the number of times render_present has been called.
+    virtual int64_t frame_count() const noexcept = 0;
+
+    //! write the framebuffer as a binary (P6) PPM image.
+    virtual bool write_ppm(char const* filename) const = 0;
+
+    //! write the framebuffer as an RGBA PNG image.
+    virtual bool write_png(char const* filename) const = 0;
+};
+
+std::unique_ptr<software_renderer> make_software_renderer(sizei32x w, sizei32y h);
+
+//! Decode the texture atlas @p filename as make_software_renderer does, and
+//! discard it; for measuring the cost of each atlas on its own.
+//! @returns false if the atlas couldn't be read.
+bool decode_texture_atlas(char const* filename);
+
+} //namespace boken
@@ -13,8 +13,27 @@
 #include <rapidjson/reader.h>
 #include <rapidjson/filereadstream.h>
 
+#include <algorithm>
+#include <future>
+#include <initializer_list>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
 
 namespace boken {
 
@@ -665,8 +684,10 @@ bool entity_definition_handler::run() {
 
 namespace {
 
+//! @returns false, after reporting why, if @p filename couldn't be read, isn't
+//! valid, or one of its definitions was rejected by a callback.
 template <typename Handler, typename Finish, typename Property>
-void impl_load_definitions_(
+bool impl_load_definitions_(
     string_view const filename
   , Finish   const& on_finish
   , Property const& on_property
@@ -680,7 +701,8 @@ void impl_load_definitions_(
 
     auto const handle = fopen(filename.data(), "rb");
     if (!handle) {
-        BK_ASSERT(false); // TODO error handing
+        printf("error: couldn't open \"%s\"\n", filename.data());
+        return false;
     }
 
     auto const on_exit = BK_SCOPE_EXIT {
@@ -691,26 +713,566 @@ void impl_load_definitions_(
 
     auto const result = reader.Parse(in, handler);
     if (!result) {
-        BK_ASSERT(false); //TODO parsing error
+        printf("error: couldn't load \"%s\"; error %d at offset %zu\n"
+             , filename.data(), static_cast<int>(result.Code()), result.Offset());
+        return false;
     }
+
+    return true;
 }
 
 } // namespace
 
-void load_item_definitions(
-    on_finish_item_definition const& on_finish
-  , on_add_new_item_property  const& on_property
+namespace {
+
+constexpr char const* default_item_filename   = "./data/items.dat";
+constexpr char const* default_entity_filename = "./data/entities.dat";
+constexpr char const* default_cache_filename  = "./data/definitions.cache";
+
+} // namespace
+
+//===------------------------------------------------------------------------===
+//                            Definition cache
+//===------------------------------------------------------------------------===
+// The cache is a single file holding a header followed by the sections below;
+// every offset is in bytes from the start of the file, and every count is in
+// elements. Strings are interned, and referred to by their offset and size
+// within the string section. The tile mappings are not stored separately;
+// they are the "tile_index" property of each definition.
+//
+// The cache is only ever read on the machine that wrote it, so values are in
+// the native byte order.
+namespace {
+
+constexpr uint32_t cache_magic   = 0x42444b42u; // "BKDB"
+constexpr uint32_t cache_version = 1;
+
+struct cache_section {
+    uint32_t offset;
+    uint32_t count;
+};
+
+struct cache_string {
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct cache_value {
+    uint32_t     property; //!< the hash of the property name
+    uint32_t     value;
+    uint32_t     type;     //!< serialize_data_type
+    cache_string name;
+};
+
+struct cache_definition {
+    uint32_t     id;
+    cache_string id_string;
+    cache_string name;
+    uint32_t     first_value;
+    uint32_t     value_count;
+};
+
+struct cache_header {
+    uint32_t      magic;
+    uint32_t      version;
+    uint64_t      source_hash; //!< of the definition files the cache was built from
+    cache_section strings;
+    cache_section values;
+    cache_section item_defs;
+    cache_section entity_defs;
+};
+
+static_assert(std::is_trivially_copyable<cache_header>::value, "");
+static_assert(std::is_trivially_copyable<cache_value>::value, "");
+static_assert(std::is_trivially_copyable<cache_definition>::value, "");
+
+//! A read only view of the contents of a file, mapped into memory; empty if
+//! the file doesn't exist, is empty, or can't be mapped.
+class mapped_file {
+public:
+    explicit mapped_file(string_view filename) noexcept;
+    ~mapped_file();
+
+    mapped_file(mapped_file const&) = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+
+    char const* data() const noexcept { return data_; }
+    size_t      size() const noexcept { return size_; }
+
+    explicit operator bool() const noexcept { return !!data_; }
+private:
+    char const* data_ {};
+    size_t      size_ {};
+};
+
+#if defined(_WIN32)
+mapped_file::mapped_file(string_view const filename) noexcept {
+    auto const file = ::CreateFileA(filename.data(), GENERIC_READ
+      , FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    auto const on_exit = BK_SCOPE_EXIT {
+        ::CloseHandle(file);
+    };
+
+    LARGE_INTEGER size {};
+    if (!::GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+        return;
+    }
+
+    auto const mapping = ::CreateFileMappingA(
+        file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (!mapping) {
+        return;
+    }
+
+    // the view keeps the mapping alive
+    auto const view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    ::CloseHandle(mapping);
+
+    if (view) {
+        data_ = static_cast<char const*>(view);
+        size_ = static_cast<size_t>(size.QuadPart);
+    }
+}
+
+mapped_file::~mapped_file() {
+    if (data_) {
+        ::UnmapViewOfFile(data_);
+    }
+}
+#else
+mapped_file::mapped_file(string_view const filename) noexcept {
+    auto const fd = ::open(filename.data(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    auto const on_exit = BK_SCOPE_EXIT {
+        ::close(fd);
+    };
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        return;
+    }
+
+    auto const size = static_cast<size_t>(info.st_size);
+    auto const view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (view != MAP_FAILED) {
+        data_ = static_cast<char const*>(view);
+        size_ = size;
+    }
+}
+
+mapped_file::~mapped_file() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+#endif
+
+//! A hash (64 bit FNV-1a) of the contents of the given files; 0 if any of them
+//! can't be read.
+uint64_t hash_files_(std::initializer_list<string_view> const filenames) noexcept {
+    uint64_t hash = 14695981039346656037u;
+
+    auto const update = [&](char const* const first, size_t const size) noexcept {
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<uint8_t>(first[i])) * 1099511628211u;
+        }
+    };
+
+    for (auto const& filename : filenames) {
+        mapped_file const file {filename};
+        if (!file) {
+            return 0;
+        }
+
+        // the size separates the files
+        uint64_t const size = file.size();
+        update(file.data(), file.size());
+        update(reinterpret_cast<char const*>(&size), sizeof(size));
+    }
+
+    return hash ? hash : 1u;
+}
+
+//! Collects the definitions of one kind, as they are parsed, into the form of
+//! the cache. Items and entities are parsed concurrently, each into their own
+//! builder; the two are merged, in a fixed order, when the cache is written.
+class cache_builder {
+public:
+    //! Called for every property as it is parsed; properties are reported
+    //! before the definition they belong to is finished.
+    void add_property(
+        string_view         const name
+      , uint32_t            const hash
+      , serialize_data_type const type
+      , uint32_t            const value
+    ) {
+        values_.push_back({hash, value, static_cast<uint32_t>(type), intern_(name)});
+    }
+
+    //! the properties reported since the last definition was finished are
+    //! those of @p def; they are kept as reported, duplicates included, so
+    //! that reading the cache reproduces parsing exactly.
+    template <typename Definition>
+    void add(Definition const& def) {
+        auto const last = static_cast<uint32_t>(values_.size());
+        defs_.push_back({value_cast(def.id)
+          , intern_(def.id_string), intern_(def.name), first_, last - first_});
+
+        first_ = last;
+    }
+
+    friend bool write_cache_(string_view filename, uint64_t source_hash
+      , cache_builder const& items, cache_builder const& entities);
+private:
+    cache_string intern_(string_view const s) {
+        auto const it = interned_.find(s.to_string());
+        if (it != end(interned_)) {
+            return it->second;
+        }
+
+        auto const result = cache_string {
+            static_cast<uint32_t>(strings_.size())
+          , static_cast<uint32_t>(s.size())};
+
+        strings_.append(s.data(), s.size());
+        interned_.emplace(s.to_string(), result);
+
+        return result;
+    }
+
+    std::string                                   strings_;
+    std::unordered_map<std::string, cache_string> interned_;
+    std::vector<cache_value>                      values_;
+    std::vector<cache_definition>                 defs_;
+    uint32_t                                      first_ {0};
+};
+
+bool write_cache_(
+    string_view   const  filename
+  , uint64_t      const  source_hash
+  , cache_builder const& items
+  , cache_builder const& entities
 ) {
-    impl_load_definitions_<item_definition_handler>(
-        "./data/items.dat", on_finish, on_property);
+    // the entities follow the items in the string and value sections
+    auto const string_offset = static_cast<uint32_t>(items.strings_.size());
+    auto const value_offset  = static_cast<uint32_t>(items.values_.size());
+
+    auto strings = items.strings_ + entities.strings_;
+
+    auto values = items.values_;
+    for (auto v : entities.values_) {
+        v.name.offset += string_offset;
+        values.push_back(v);
+    }
+
+    auto entity_defs = entities.defs_;
+    for (auto& d : entity_defs) {
+        d.id_string.offset += string_offset;
+        d.name.offset      += string_offset;
+        d.first_value      += value_offset;
+    }
+
+    std::vector<char> buffer (sizeof(cache_header));
+
+    auto const append = [&](void const* const data, size_t const size, size_t const n) {
+        // keep every section aligned for its elements
+        buffer.resize((buffer.size() + 7u) & ~size_t {7u});
+
+        auto const offset = buffer.size();
+        auto const p = static_cast<char const*>(data);
+        buffer.insert(end(buffer), p, p + size * n);
+
+        return cache_section {static_cast<uint32_t>(offset), static_cast<uint32_t>(n)};
+    };
+
+    cache_header header {};
+    header.magic       = cache_magic;
+    header.version     = cache_version;
+    header.source_hash = source_hash;
+    header.strings     = append(strings.data(),     1u,                       strings.size());
+    header.values      = append(values.data(),      sizeof(cache_value),      values.size());
+    header.item_defs   = append(items.defs_.data(), sizeof(cache_definition), items.defs_.size());
+    header.entity_defs = append(entity_defs.data(), sizeof(cache_definition), entity_defs.size());
+
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    // write to a temporary first so that a partially written cache is never
+    // read.
+    auto const tmp_filename = filename.to_string() + ".tmp";
+
+    auto const handle = fopen(tmp_filename.data(), "wb");
+    if (!handle) {
+        return false;
+    }
+
+    auto const ok = fwrite(buffer.data(), 1u, buffer.size(), handle) == buffer.size();
+    auto const closed = fclose(handle) == 0;
+
+    if (!ok || !closed) {
+        std::remove(tmp_filename.data());
+        return false;
+    }
+
+    std::remove(filename.data());
+    return std::rename(tmp_filename.data(), filename.data()) == 0;
+}
+
+//! Reads the definitions from a cache which has been validated.
+class cache_reader {
+public:
+    cache_reader(char const* const data, size_t const size) noexcept
+      : data_ {data}
+      , size_ {size}
+    {
+    }
+
+    //! @returns true if the cache is complete, well formed, and was built from
+    //! definition files with the hash @p source_hash.
+    bool is_valid(uint64_t source_hash) const noexcept;
+
+    template <typename Definition, typename Finish, typename Property>
+    bool read(Finish const& on_finish, Property const& on_property) const;
+private:
+    cache_header header_() const noexcept {
+        cache_header result;
+        std::memcpy(&result, data_, sizeof(result));
+        return result;
+    }
+
+    template <typename T>
+    bool is_valid_(cache_section const s) const noexcept {
+        return (s.offset % alignof(T) == 0)
+            && (s.offset <= size_)
+            && (s.count  <= (size_ - s.offset) / sizeof(T));
+    }
+
+    bool is_valid_(cache_string const s, cache_section const strings) const noexcept {
+        return s.offset <= strings.count
+            && s.size   <= strings.count - s.offset;
+    }
+
+    template <typename T>
+    T const* get_(cache_section const s) const noexcept {
+        return reinterpret_cast<T const*>(data_ + s.offset);
+    }
+
+    string_view get_(cache_string const s) const noexcept {
+        return {get_<char>(header_().strings) + s.offset, s.size};
+    }
+
+    static cache_section defs_(item_definition const*, cache_header const& h) noexcept {
+        return h.item_defs;
+    }
+
+    static cache_section defs_(entity_definition const*, cache_header const& h) noexcept {
+        return h.entity_defs;
+    }
+
+    char const* data_;
+    size_t      size_;
+};
+
+bool cache_reader::is_valid(uint64_t const source_hash) const noexcept {
+    if (!data_ || size_ < sizeof(cache_header)) {
+        return false;
+    }
+
+    auto const h = header_();
+
+    if (h.magic       != cache_magic
+     || h.version     != cache_version
+     || h.source_hash != source_hash
+     || !is_valid_<char>(h.strings)
+     || !is_valid_<cache_value>(h.values)
+     || !is_valid_<cache_definition>(h.item_defs)
+     || !is_valid_<cache_definition>(h.entity_defs)
+    ) {
+        return false;
+    }
+
+    auto const values = get_<cache_value>(h.values);
+    for (uint32_t i = 0; i < h.values.count; ++i) {
+        auto const& v = values[i];
+        if (v.type > static_cast<uint32_t>(serialize_data_type::string)
+         || !is_valid_(v.name, h.strings)
+        ) {
+            return false;
+        }
+    }
+
+    auto const check_defs = [&](cache_section const s) noexcept {
+        auto const defs = get_<cache_definition>(s);
+        return std::all_of(defs, defs + s.count, [&](cache_definition const& d) noexcept {
+            return is_valid_(d.id_string, h.strings)
+                && is_valid_(d.name, h.strings)
+                && d.first_value <= h.values.count
+                && d.value_count <= h.values.count - d.first_value;
+        });
+    };
+
+    return check_defs(h.item_defs) && check_defs(h.entity_defs);
+}
+
+template <typename Definition, typename Finish, typename Property>
+bool cache_reader::read(Finish const& on_finish, Property const& on_property) const {
+    using id_t       = typename Definition::definition_id_t;
+    using property_t = typename Definition::property_t;
+
+    auto const h      = header_();
+    auto const s      = defs_(static_cast<Definition const*>(nullptr), h);
+    auto const defs   = get_<cache_definition>(s);
+    auto const values = get_<cache_value>(h.values);
+
+    Definition def;
+
+    for (uint32_t i = 0; i < s.count; ++i) {
+        auto const& d = defs[i];
+
+        def.id = id_t {d.id};
+        def.id_string.assign(get_(d.id_string).data(), d.id_string.size);
+        def.name.assign(get_(d.name).data(), d.name.size);
+        def.properties.clear();
+
+        auto const first = values + d.first_value;
+        auto const last  = first + d.value_count;
+
+        for (auto it = first; it != last; ++it) {
+            auto const ok = on_property(get_(it->name), it->property
+              , static_cast<serialize_data_type>(it->type), it->value);
+
+            if (!ok) {
+                return false;
+            }
+
+            def.properties.add_or_update_property(property_t {it->property}, it->value);
+        }
+
+        on_finish(def);
+    }
+
+    return true;
+}
+
+} // namespace
+
+definition_source load_definitions(
+    string_view                 const  item_filename
+  , string_view                 const  entity_filename
+  , string_view                 const  cache_filename
+  , on_finish_item_definition   const& on_finish_item
+  , on_add_new_item_property    const& on_item_property
+  , on_finish_entity_definition const& on_finish_entity
+  , on_add_new_entity_property  const& on_entity_property
+) {
+    auto const source_hash = hash_files_({item_filename, entity_filename});
+
+    // items and entities are independent; each is read on its own thread, and
+    // their callbacks may be called concurrently.
+    auto const concurrently = [](auto&& item_task, auto&& entity_task) {
+        auto items = std::async(std::launch::async, item_task);
+        auto const entities_result = entity_task();
+        auto const items_result    = items.get();
+        return items_result && entities_result;
+    };
+
+    if (source_hash) {
+        mapped_file  const cache  {cache_filename};
+        cache_reader const reader {cache.data(), cache.size()};
+
+        // the cache is validated as a whole before anything is read from it,
+        // so it can only fail if a callback rejects a definition. There is no
+        // falling back to the definition files then; everything up to that
+        // point has already been reported.
+        if (reader.is_valid(source_hash)) {
+            auto const ok = concurrently(
+                [&] { return reader.read<item_definition>(on_finish_item, on_item_property); }
+              , [&] { return reader.read<entity_definition>(on_finish_entity, on_entity_property); });
+
+            if (!ok) {
+                printf("error: a definition in \"%s\" was rejected\n"
+                     , cache_filename.data());
+                return definition_source::failed;
+            }
+
+            return definition_source::cache;
+        }
+    }
+
+    cache_builder items;
+    cache_builder entities;
+
+    on_finish_item_definition const finish_item = [&](item_definition const& def) {
+        items.add(def);
+        on_finish_item(def);
+    };
+
+    on_add_new_item_property const item_property = [&](
+        string_view         const name
+      , uint32_t            const hash
+      , serialize_data_type const type
+      , uint32_t            const value
+    ) {
+        items.add_property(name, hash, type, value);
+        return on_item_property(name, hash, type, value);
+    };
+
+    on_finish_entity_definition const finish_entity = [&](entity_definition const& def) {
+        entities.add(def);
+        on_finish_entity(def);
+    };
+
+    on_add_new_entity_property const entity_property = [&](
+        string_view         const name
+      , uint32_t            const hash
+      , serialize_data_type const type
+      , uint32_t            const value
+    ) {
+        entities.add_property(name, hash, type, value);
+        return on_entity_property(name, hash, type, value);
+    };
+
+    auto const ok = concurrently(
+        [&] {
+            return impl_load_definitions_<item_definition_handler>(
+                item_filename, finish_item, item_property);
+        }
+      , [&] {
+            return impl_load_definitions_<entity_definition_handler>(
+                entity_filename, finish_entity, entity_property);
+        });
+
+    // only cache a complete set of definitions
+    if (!ok) {
+        return definition_source::failed;
+    }
+
+    if (source_hash && !write_cache_(cache_filename, source_hash, items, entities)) {
+        printf("warning: couldn't write the definition cache \"%s\"\n"
+             , cache_filename.data());
+    }
+
+    return definition_source::original;
 }
 
-void load_entity_definitions(
-    on_finish_entity_definition const& on_finish
-  , on_add_new_entity_property  const& on_property
+definition_source load_definitions(
+    on_finish_item_definition   const& on_finish_item
+  , on_add_new_item_property    const& on_item_property
+  , on_finish_entity_definition const& on_finish_entity
+  , on_add_new_entity_property  const& on_entity_property
 ) {
-    impl_load_definitions_<entity_definition_handler>(
-        "./data/entities.dat", on_finish, on_property);
+    return load_definitions(default_item_filename, default_entity_filename
+      , default_cache_filename, on_finish_item, on_item_property
+      , on_finish_entity, on_entity_property);
 }
 
 } //namespace boken
@@ -29,14 +29,41 @@ using on_finish_entity_definition = std::function<
 
 using on_add_new_entity_property = on_add_new_item_property;
 
-void load_item_definitions(
-    on_finish_item_definition const& on_finish
-  , on_add_new_item_property  const& on_property
+enum class definition_source : uint32_t {
+    cache    //!< read from a cache built from the current definition files
+  , original //!< parsed from the definition files; the cache was rebuilt
+  , failed   //!< reported as an error; only some definitions were loaded
+};
+
+//! Load the item and entity definitions from a precompiled binary cache if it
+//! was built from the current contents of the definition files. Otherwise,
+//! parse the definition files and rebuild the cache. The callbacks see the
+//! same definitions and properties, in the same order, either way.
+//!
+//! If a definition file can't be read or parsed, or a property callback
+//! rejects a property, the error is reported and the result is failed. The
+//! definitions reported up to that point are all there is, and the cache is
+//! left as it was.
+//!
+//! Items and entities are loaded concurrently: the item callbacks and the
+//! entity callbacks may be called at the same time, from different threads.
+//! Each pair is only ever called from one thread at a time, in order.
+definition_source load_definitions(
+    on_finish_item_definition   const& on_finish_item
+  , on_add_new_item_property    const& on_item_property
+  , on_finish_entity_definition const& on_finish_entity
+  , on_add_new_entity_property  const& on_entity_property
 );
 
-void load_entity_definitions(
-    on_finish_entity_definition const& on_finish
-  , on_add_new_entity_property  const& on_property
+//! As above, but with the given definition and cache files.
+definition_source load_definitions(
+    string_view                        item_filename
+  , string_view                        entity_filename
+  , string_view                        cache_filename
+  , on_finish_item_definition   const& on_finish_item
+  , on_add_new_item_property    const& on_item_property
+  , on_finish_entity_definition const& on_finish_entity
+  , on_add_new_entity_property  const& on_entity_property
 );
 
 uint32_t to_property(std::nullptr_t n) noexcept;
@@ -3,6 +3,7 @@
 #include "math_types.hpp"
 #include "system_input.hpp"
 
+#include <chrono>
 #include <memory>
 #include <functional>
 
@@ -13,6 +14,8 @@ namespace boken {
 class system {
 public:
     using on_resize_handler       = std::function<void (int32_t, int32_t)>;
+    using on_expose_handler       = std::function<void ()>;
+    using on_render_reset_handler = std::function<void ()>;
     using on_request_quit_handler = std::function<bool ()>;
     using on_key_handler          = std::function<void (kb_event, kb_modifiers)>;
     using on_mouse_move_handler   = std::function<void (mouse_event, kb_modifiers)>;
@@ -23,6 +26,15 @@ public:
     virtual ~system();
 
     virtual void on_resize(on_resize_handler handler) = 0;
+
+    //! @p handler is called when the contents of the window have been lost
+    //! and must be redrawn, although nothing has changed.
+    virtual void on_expose(on_expose_handler handler) = 0;
+
+    //! @p handler is called when the contents of every render target have
+    //! been lost; e.g. after the graphics device is reset.
+    virtual void on_render_reset(on_render_reset_handler handler) = 0;
+
     virtual void on_request_quit(on_request_quit_handler handler) = 0;
     virtual void on_key(on_key_handler handler) = 0;
     virtual void on_mouse_move(on_mouse_move_handler handler) = 0;
@@ -31,8 +43,15 @@ public:
     virtual void on_text_input(on_text_input_handler handler) = 0;
 
     virtual bool is_running() = 0;
+
+    //! process every pending event.
+    //! @returns the number of events processed.
     virtual int32_t do_events() = 0;
 
+    //! as do_events, but first block for up to @p timeout until an event
+    //! arrives.
+    virtual int32_t wait_events(std::chrono::milliseconds timeout) = 0;
+
     virtual recti32 get_client_rect() const = 0;
 };
 
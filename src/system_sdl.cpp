@@ -3,13 +3,20 @@
 #include "math.hpp"             // for ceil_as
 #include "config.hpp"
 #include "algorithm.hpp"
+#include "memory_stats.hpp"
 
 #include <bkassert/assert.hpp>
 
 #define SDL_MAIN_HANDLED
 #include <SDL2/SDL.h>
 
+// SDL_RenderGeometry is available from 2.0.18 onward
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+#   define BK_SDL_HAS_RENDER_GEOMETRY
+#endif
+
 #include <functional>           // for function
+#include <future>               // for async
 #include <memory>               // for unique_ptr
 #include <stdexcept>            // for runtime_error
 #include <tuple>                // for tie, tuple
@@ -191,12 +198,16 @@ private:
     int height_ {};
 };
 
-sdl_texture create_font_texture(sdl_renderer& render) {
+//! Decoding a BMP doesn't involve the renderer; unlike creating a texture, it
+//! can be done on any thread.
+sdl_surface load_surface_from_file(string_view const filename) {
+    return sdl_surface {SDL_LoadBMP(filename.data())};
+}
+
+//! @param source The font atlas; left unchanged.
+sdl_texture create_font_texture(sdl_renderer& render, SDL_Surface* const source) {
     auto converted = sdl_surface {
-        SDL_ConvertSurfaceFormat(
-            sdl_surface {SDL_LoadBMP("./data/tiles.bmp")}
-          , SDL_PIXELFORMAT_RGBA8888
-          , 0)};
+        SDL_ConvertSurfaceFormat(source, SDL_PIXELFORMAT_RGBA8888, 0)};
 
     auto const w     = converted->w;
     auto const h     = converted->h;
@@ -226,9 +237,8 @@ sdl_texture create_font_texture(sdl_renderer& render) {
     return result;
 }
 
-sdl_texture create_texture_from_file(sdl_renderer& render, string_view const filename) {
-    auto result = sdl_texture {SDL_CreateTextureFromSurface(render
-        , sdl_surface {SDL_LoadBMP(filename.data())})};
+sdl_texture create_texture(sdl_renderer& render, SDL_Surface* const source) {
+    auto result = sdl_texture {SDL_CreateTextureFromSurface(render, source)};
 
     if (!result) {
         throw sdl_error {SDL_GetError()};
@@ -264,6 +274,8 @@ public:
         SDL_GetWindowSize(window_, &window_w_, &window_h_);
 
         handler_resize_       = ignore {};
+        handler_expose_       = [](    ) noexcept {};
+        handler_render_reset_ = [](    ) noexcept {};
         handler_quit_         = [](    ) noexcept { return true; };
         handler_key_          = [](auto, auto) noexcept {};
         handler_mouse_move_   = [](auto, auto) noexcept {};
@@ -314,6 +326,8 @@ public:
         handler_mouse_move_(m, get_key_mods());
     }
 
+    void handle_event(SDL_Event const& event);
+
     void handle_window_event(SDL_WindowEvent const& e) {
         //SDL_WINDOWEVENT_NONE,           /**< Never used */
         //SDL_WINDOWEVENT_SHOWN,          /**< Window has been shown */
@@ -338,6 +352,11 @@ public:
         switch (e.event) {
         case SDL_WINDOWEVENT_SIZE_CHANGED :
             break;
+        case SDL_WINDOWEVENT_EXPOSED : {
+            // the contents of the window need to be redrawn
+            handler_expose_();
+            break;
+        }
         case SDL_WINDOWEVENT_RESIZED : {
             window_w_ = e.data1;
             window_h_ = e.data2;
@@ -357,6 +376,14 @@ public:
         handler_resize_ = std::move(handler);
     }
 
+    void on_expose(on_expose_handler handler) final override {
+        handler_expose_ = std::move(handler);
+    }
+
+    void on_render_reset(on_render_reset_handler handler) final override {
+        handler_render_reset_ = std::move(handler);
+    }
+
     void on_request_quit(on_request_quit_handler handler) final override {
         handler_quit_ = std::move(handler);
     }
@@ -386,6 +413,7 @@ public:
     }
 
     int do_events() final override;
+    int wait_events(std::chrono::milliseconds timeout) final override;
 
     recti32 get_client_rect() const final override {
         int w = 0;
@@ -395,6 +423,8 @@ public:
     }
 private:
     on_resize_handler       handler_resize_;
+    on_expose_handler       handler_expose_;
+    on_render_reset_handler handler_render_reset_;
     on_request_quit_handler handler_quit_;
     on_key_handler          handler_key_;
     on_mouse_move_handler   handler_mouse_move_;
@@ -418,47 +448,71 @@ int sdl_system::do_events() {
     int count = 0;
 
     for (SDL_Event event; SDL_PollEvent(&event); ++count) {
-        switch (event.type) {
-        case SDL_WINDOWEVENT :
-            handle_window_event(event.window);
-            break;
-        case SDL_QUIT:
-            running_ = !handler_quit_();
-            break;
-        case SDL_TEXTINPUT :
-            handler_text_input_(text_input_event {
-                event.text.timestamp
-              , event.text.text});
-            break;
-        case SDL_KEYDOWN :
-        case SDL_KEYUP :
-            handler_key_(kb_event {
-                event.key.timestamp
-                , static_cast<kb_scancode>(event.key.keysym.scancode)
-                , static_cast<kb_keycode>(event.key.keysym.sym)
-                , event.key.keysym.mod
-                , !!event.key.repeat
-                , event.key.state == SDL_PRESSED
-            }, kb_modifiers {event.key.keysym.mod});
-            break;
-        case SDL_MOUSEMOTION :
-            handle_event_mouse_move(event.motion);
-            break;
-        case SDL_MOUSEBUTTONDOWN :
-        case SDL_MOUSEBUTTONUP :
-            handle_event_mouse_button(event.button);
-            break;
-        case SDL_MOUSEWHEEL :
-            handler_mouse_wheel_(event.wheel.y, event.wheel.x, get_key_mods());
-            break;
-        default:
-            break;
-        }
+        handle_event(event);
     }
 
     return count;
 }
 
+int sdl_system::wait_events(std::chrono::milliseconds const timeout) {
+    using std::chrono::milliseconds;
+    auto const ms = static_cast<int>(std::max(timeout, milliseconds {0}).count());
+
+    SDL_Event event;
+    if (!SDL_WaitEventTimeout(&event, ms)) {
+        return 0;
+    }
+
+    handle_event(event);
+
+    return 1 + do_events();
+}
+
+void sdl_system::handle_event(SDL_Event const& event) {
+    switch (event.type) {
+    case SDL_WINDOWEVENT :
+        handle_window_event(event.window);
+        break;
+    case SDL_QUIT:
+        running_ = !handler_quit_();
+        break;
+    case SDL_RENDER_TARGETS_RESET :
+    case SDL_RENDER_DEVICE_RESET :
+        // e.g. Direct3D discards the contents of render targets on a resize
+        // or when the device is lost
+        handler_render_reset_();
+        break;
+    case SDL_TEXTINPUT :
+        handler_text_input_(text_input_event {
+            event.text.timestamp
+          , event.text.text});
+        break;
+    case SDL_KEYDOWN :
+    case SDL_KEYUP :
+        handler_key_(kb_event {
+            event.key.timestamp
+            , static_cast<kb_scancode>(event.key.keysym.scancode)
+            , static_cast<kb_keycode>(event.key.keysym.sym)
+            , event.key.keysym.mod
+            , !!event.key.repeat
+            , event.key.state == SDL_PRESSED
+        }, kb_modifiers {event.key.keysym.mod});
+        break;
+    case SDL_MOUSEMOTION :
+        handle_event_mouse_move(event.motion);
+        break;
+    case SDL_MOUSEBUTTONDOWN :
+    case SDL_MOUSEBUTTONUP :
+        handle_event_mouse_button(event.button);
+        break;
+    case SDL_MOUSEWHEEL :
+        handler_mouse_wheel_(event.wheel.y, event.wheel.x, get_key_mods());
+        break;
+    default:
+        break;
+    }
+}
+
 std::unique_ptr<system> make_system() {
     return std::make_unique<sdl_system>();
 }
@@ -517,6 +571,58 @@ public:
         transform({1.0f, 1.0f, 0.0f, 0.0f}).dismiss();
     }
 
+    uint32_t create_render_target(sizei32x const w, sizei32y const h) final override {
+        auto const id = static_cast<uint32_t>(textures_.size());
+
+        textures_.push_back(sdl_texture {SDL_CreateTexture(r_
+          , SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET
+          , value_cast(w), value_cast(h))});
+
+        if (SDL_SetTextureBlendMode(textures_.back(), SDL_BLENDMODE_BLEND)) {
+            throw sdl_error {SDL_GetError()};
+        }
+
+        // the initial contents of the texture are undefined
+        auto const target = render_target(id);
+        r_.set_draw_color(0);
+        SDL_RenderClear(r_);
+
+        return id;
+    }
+
+    void set_render_target(uint32_t const id) final override {
+        BK_ASSERT(id == target_window || id < textures_.size());
+
+        SDL_Texture* const target = (id == target_window)
+          ? nullptr
+          : static_cast<SDL_Texture*>(textures_[id]);
+
+        if (SDL_SetRenderTarget(r_, target)) {
+            throw sdl_error {SDL_GetError()};
+        }
+
+        target_ = id;
+
+        // the scale and clip rect are reset by SDL when the target changes
+        set_transform(trans_);
+
+        if (id == target_window) {
+            set_clip_rect(clip_rect_);
+        } else if (SDL_RenderSetClipRect(r_, nullptr)) {
+            throw sdl_error {SDL_GetError()};
+        }
+    }
+
+    undo_render_target render_target(uint32_t const id) final override {
+        auto const prev = target_;
+        set_render_target(id);
+        return {*this, prev};
+    }
+
+    void render_target() final override {
+        set_render_target(target_window);
+    }
+
     void render_clear() final override {
         SDL_SetRenderDrawColor(r_, 127, 127, 0, 255);
         SDL_RenderClear(r_);
@@ -525,6 +631,15 @@ public:
         SDL_RenderPresent(r_);
     }
 
+    void clear_rect(recti32 const r) final override {
+        auto const rect = make_sdl_rect_(r);
+
+        SDL_SetRenderDrawBlendMode(r_, SDL_BLENDMODE_NONE);
+        r_.set_draw_color(0);
+        SDL_RenderFillRect(r_, &rect);
+        SDL_SetRenderDrawBlendMode(r_, SDL_BLENDMODE_BLEND);
+    }
+
     void fill_rect(recti32 const r, uint32_t const color) final override {
         fill_rects(&r, &r + 1, color);
     }
@@ -589,75 +704,132 @@ public:
 
     void draw_background() final override;
 
+    draw_stats stats() const noexcept final override {
+        return stats_;
+    }
+
     void draw_tiles(tile_params_uniform const& p) final override {
-        BK_ASSERT(p.count >= 0
-               && p.texture_id < textures_.size());
+        auto const w = value_cast(p.tile_w);
+        auto const h = value_cast(p.tile_h);
+
+        BK_ASSERT(w >= 0 && h >= 0);
+
+        draw_tiles_impl(p.texture_id, p.count, p.pos_coords, p.tex_coords
+          , p.colors, [&]() noexcept { return std::make_pair(w, h); });
+    }
+
+    void draw_tiles(tile_params_variable const& p) final override {
+        draw_tiles_impl(p.texture_id, p.count, p.pos_coords, p.tex_coords
+          , p.colors, [p_wh = p.tex_sizes]() mutable noexcept {
+                auto const wh = p_wh.value<point2i16>();
+                ++p_wh;
+                return std::make_pair(int {value_cast(wh.x)}
+                                    , int {value_cast(wh.y)});
+            });
+    }
+
+//------------------------------------------------------------------------------
 
-        auto&               texture    = textures_[p.texture_id];
+    //! Common implementation for draw_tiles; @p next_size returns the size of
+    //! each successive tile as a pair (w, h).
+    template <typename NextSize>
+    void draw_tiles_impl(
+        uint32_t            const texture_id
+      , int32_t             const count
+      , read_only_pointer_t       p_xy
+      , read_only_pointer_t       p_st
+      , read_only_pointer_t       p_c
+      , NextSize                  next_size
+    ) {
+        BK_ASSERT(count >= 0
+               && texture_id < textures_.size());
+
+        auto&               texture    = textures_[texture_id];
         SDL_Texture*  const tex_handle = texture;
         SDL_Renderer* const renderer   = r_;
 
-        uint32_t last_color = 0;
-        texture.set_color_mod(last_color);
-
         auto const tx = ceil_as<int>(trans_.trans_x / trans_.scale_x);
         auto const ty = ceil_as<int>(trans_.trans_y / trans_.scale_y);
-        auto const w  = value_cast(p.tile_w);
-        auto const h  = value_cast(p.tile_h);
 
-        BK_ASSERT(w >= 0 && h >= 0);
+        auto const n = static_cast<size_t>(count);
 
-        auto p_xy = p.pos_coords;
-        auto p_st = p.tex_coords;
-        auto p_c  = p.colors;
+        ++stats_.draw_tiles_calls;
+        stats_.tiles += count;
 
-        auto const n = static_cast<size_t>(p.count);
-        for (size_t i = 0; i < n; ++i, ++p_xy, ++p_st, ++p_c) {
-            auto const xy    = p_xy.value<point2i16>();
-            auto const st    = p_st.value<point2i16>();
-            auto const color = p_c.value<uint32_t>();
-
-            if (color != last_color) {
-                texture.set_color_mod(last_color = color);
-            }
+#if defined(BK_SDL_HAS_RENDER_GEOMETRY)
+        // Batch every tile into a single list of textured quads; the color is
+        // applied per vertex rather than by changing the color mod per tile.
+        auto const sx = 1.0f / static_cast<float>(texture.width());
+        auto const sy = 1.0f / static_cast<float>(texture.height());
 
-            SDL_Rect src {value_cast(st.x),      value_cast(st.y),      w, h};
-            SDL_Rect dst {value_cast(xy.x) + tx, value_cast(xy.y) + ty, w, h};
+        vertices_.clear();
+        indices_.clear();
+        vertices_.reserve(n * 4);
+        indices_.reserve(n * 6);
 
-            SDL_RenderCopy(renderer, tex_handle, &src, &dst);
+        for (size_t i = 0; i < n; ++i, ++p_xy, ++p_st, ++p_c) {
+            auto const xy = p_xy.value<point2i16>();
+            auto const st = p_st.value<point2i16>();
+            auto const wh = next_size();
+            auto const c  = p_c.value<uint32_t>();
+
+            SDL_Color const color {
+                static_cast<uint8_t>((c >>  0) & 0xFFu)
+              , static_cast<uint8_t>((c >>  8) & 0xFFu)
+              , static_cast<uint8_t>((c >> 16) & 0xFFu)
+              , 0xFFu};
+
+            auto const x0 = static_cast<float>(value_cast(xy.x) + tx);
+            auto const y0 = static_cast<float>(value_cast(xy.y) + ty);
+            auto const x1 = x0 + static_cast<float>(wh.first);
+            auto const y1 = y0 + static_cast<float>(wh.second);
+
+            auto const s0 = sx * static_cast<float>(value_cast(st.x));
+            auto const t0 = sy * static_cast<float>(value_cast(st.y));
+            auto const s1 = s0 + sx * static_cast<float>(wh.first);
+            auto const t1 = t0 + sy * static_cast<float>(wh.second);
+
+            auto const base = static_cast<int>(vertices_.size());
+
+            vertices_.push_back({{x0, y0}, color, {s0, t0}});
+            vertices_.push_back({{x1, y0}, color, {s1, t0}});
+            vertices_.push_back({{x0, y1}, color, {s0, t1}});
+            vertices_.push_back({{x1, y1}, color, {s1, t1}});
+
+            for (auto const j : {0, 1, 2, 2, 1, 3}) {
+                indices_.push_back(base + j);
+            }
         }
-    }
 
-    void draw_tiles(tile_params_variable const& p) final override {
-        BK_ASSERT(p.count >= 0
-               && p.texture_id < textures_.size());
+        if (vertices_.empty()) {
+            return;
+        }
 
-        auto&               texture    = textures_[p.texture_id];
-        SDL_Texture*  const tex_handle = texture;
-        SDL_Renderer* const renderer   = r_;
+        texture.set_color_mod(0xFFFFFFFFu);
+        ++stats_.color_mod_switches;
 
+        if (SDL_RenderGeometry(renderer, tex_handle
+              , vertices_.data(), static_cast<int>(vertices_.size())
+              , indices_.data(),  static_cast<int>(indices_.size()))
+        ) {
+            throw sdl_error {SDL_GetError()};
+        }
+#else
         uint32_t last_color = 0;
         texture.set_color_mod(last_color);
+        ++stats_.color_mod_switches;
 
-        auto const tx = ceil_as<int>(trans_.trans_x / trans_.scale_x);
-        auto const ty = ceil_as<int>(trans_.trans_y / trans_.scale_y);
-
-        auto p_xy = p.pos_coords;
-        auto p_st = p.tex_coords;
-        auto p_wh = p.tex_sizes;
-        auto p_c  = p.colors;
-
-        auto const n = static_cast<size_t>(p.count);
-        for (size_t i = 0; i < n; ++i, ++p_xy, ++p_st, ++p_wh, ++p_c) {
+        for (size_t i = 0; i < n; ++i, ++p_xy, ++p_st, ++p_c) {
             auto const xy    = p_xy.value<point2i16>();
             auto const st    = p_st.value<point2i16>();
-            auto const wh    = p_wh.value<point2i16>();
-            auto const w     = value_cast(wh.x);
-            auto const h     = value_cast(wh.y);
+            auto const wh    = next_size();
+            auto const w     = wh.first;
+            auto const h     = wh.second;
             auto const color = p_c.value<uint32_t>();
 
             if (color != last_color) {
                 texture.set_color_mod(last_color = color);
+                ++stats_.color_mod_switches;
             }
 
             SDL_Rect src {value_cast(st.x),      value_cast(st.y),      w, h};
@@ -665,12 +837,13 @@ public:
 
             SDL_RenderCopy(renderer, tex_handle, &src, &dst);
         }
+#endif
     }
 
-//------------------------------------------------------------------------------
-
     template <typename FwdIt, typename SetColor>
     void fill_rects_impl(FwdIt const first, FwdIt const last, SetColor c) {
+        stats_.rects_filled += std::distance(first, last);
+
         for (auto it = first; it != last; ++it) {
             c();
 
@@ -688,6 +861,8 @@ public:
         auto const w2 = 2 * w;
         auto const h  = border_size;
 
+        stats_.rects_drawn += std::distance(first, last);
+
         for (auto it = first; it != last; ++it) {
             auto const r = *it;
 
@@ -718,8 +893,16 @@ private:
 
     std::vector<sdl_texture> textures_;
 
+#if defined(BK_SDL_HAS_RENDER_GEOMETRY)
+    //!< scratch buffers for draw_tiles
+    tracked_vector<SDL_Vertex, memory_tag::render> vertices_;
+    tracked_vector<int,        memory_tag::render> indices_;
+#endif
+
     transform_t trans_ {1.0f, 1.0f, 0.0f, 0.0f};
     recti32     clip_rect_;
+    uint32_t    target_ {target_window};
+    draw_stats  stats_  {};
 };
 
 std::unique_ptr<renderer2d> make_renderer(system& sys) {
@@ -730,23 +913,32 @@ sdl_renderer_impl::sdl_renderer_impl(system& sys)
   : sys_ {dynamic_cast<sdl_system&>(sys)}
   , r_   {sys_.renderer_}
 {
-    textures_.reserve(4);
+    // each atlas is decoded once, concurrently; the textures themselves must
+    // be created on this thread.
+    auto const load = [](char const* const filename) {
+        return std::async(std::launch::async, load_surface_from_file, filename);
+    };
+
+    auto tiles_future      = load("./data/tiles.bmp");
+    auto entities_future   = load("./data/entities.bmp");
+    auto background_future = load("./data/background.bmp");
+
+    auto const tiles      = tiles_future.get();
+    auto const entities   = entities_future.get();
+    auto const background = background_future.get();
+
+    textures_.reserve(5);
 
     //base
-    textures_.push_back(
-        create_texture_from_file(r_, "./data/tiles.bmp"));
+    textures_.push_back(create_texture(r_, tiles));
     //entities
-    textures_.push_back(
-        create_texture_from_file(r_, "./data/entities.bmp"));
+    textures_.push_back(create_texture(r_, entities));
     //items
-    textures_.push_back(
-        create_texture_from_file(r_, "./data/tiles.bmp"));
+    textures_.push_back(create_texture(r_, tiles));
     //font
-    textures_.push_back(create_font_texture(r_));
+    textures_.push_back(create_font_texture(r_, tiles));
     //background
-    textures_.push_back(
-        create_texture_from_file(r_, "./data/background.bmp"));
-
+    textures_.push_back(create_texture(r_, background));
 }
 
 void sdl_renderer_impl::draw_background() {
@@ -2,7 +2,10 @@
 #include "catch.hpp"
 #include "algorithm.hpp"
 
+#include <random>
+#include <utility>
 #include <vector>
+#include <cstdint>
 
 TEST_CASE("copy_index_if") {
     using namespace boken;
@@ -34,4 +37,46 @@ TEST_CASE("copy_index_if") {
     }
 }
 
+TEST_CASE("radix_sort_by_key") {
+    using namespace boken;
+
+    SECTION("matches std::stable_sort") {
+        std::mt19937 gen {1234};
+
+        // keys which differ only in the low and high bytes
+        std::vector<uint64_t> keys;
+        std::vector<int>      values;
+
+        for (int i = 0; i < 1000; ++i) {
+            keys.push_back((uint64_t {gen() % 4u} << 56) | (gen() % 16u));
+            values.push_back(i);
+        }
+
+        std::vector<std::pair<uint64_t, int>> expected;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            expected.emplace_back(keys[i], values[i]);
+        }
+
+        std::stable_sort(begin(expected), end(expected)
+          , [](auto const& a, auto const& b) noexcept {
+                return a.first < b.first; });
+
+        radix_sort_by_key(keys, values);
+
+        for (size_t i = 0; i < keys.size(); ++i) {
+            REQUIRE(keys[i]   == expected[i].first);
+            REQUIRE(values[i] == expected[i].second);
+        }
+    }
+
+    SECTION("identical keys leave the order unchanged") {
+        std::vector<uint32_t> keys   {7, 7, 7};
+        std::vector<int>      values {3, 1, 2};
+
+        radix_sort_by_key(keys, values);
+
+        REQUIRE((values == std::vector<int> {3, 1, 2}));
+    }
+}
+
 #endif // !defined(BK_NO_TESTS)
@@ -0,0 +1,58 @@
+#if !defined(BK_NO_TESTS)
+#include "catch.hpp"
+#include "allocator.hpp"
+
+#include <vector>
+
+TEST_CASE("contiguous_fixed_size_block_storage") {
+    using namespace boken;
+
+    contiguous_fixed_size_block_storage<int, memory_tag::world> storage;
+
+    REQUIRE(storage.capacity() == 0u);
+    REQUIRE(storage.next_block_id() == 1u);
+
+    SECTION("allocate_n with no free blocks") {
+        auto const first = storage.allocate_n(4, [](size_t const id) {
+            return static_cast<int>(id * 10);
+        });
+
+        REQUIRE(first == 1u);
+        REQUIRE(storage.capacity() == 4u);
+        REQUIRE(storage.next_block_id() == 5u);
+
+        for (size_t i = first; i < first + 4; ++i) {
+            REQUIRE(storage[i] == static_cast<int>(i * 10));
+        }
+    }
+
+    SECTION("allocate_n with free blocks") {
+        for (int i = 0; i < 4; ++i) {
+            storage.allocate(i);
+        }
+
+        storage.deallocate(2);
+        storage.deallocate(3);
+
+        auto const first = storage.allocate_n(3, [](size_t const id) {
+            return static_cast<int>(id * 10);
+        });
+
+        // the new blocks are always appended
+        REQUIRE(first == 5u);
+        REQUIRE(storage.capacity() == 7u);
+        REQUIRE(storage[5] == 50);
+        REQUIRE(storage[6] == 60);
+        REQUIRE(storage[7] == 70);
+
+        // the free blocks are reused first, and then the storage grows
+        std::vector<size_t> ids;
+        for (int i = 0; i < 3; ++i) {
+            ids.push_back(storage.allocate(i).second);
+        }
+
+        REQUIRE(ids == (std::vector<size_t> {3, 2, 8}));
+    }
+}
+
+#endif // !defined(BK_NO_TESTS)
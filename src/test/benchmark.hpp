@@ -0,0 +1,22 @@
+#pragma once
+
+#include <chrono>
+
+namespace boken { namespace test {
+
+//! @returns the wall clock time, in microseconds, taken by a call to @p f.
+template <typename F>
+std::chrono::microseconds::rep time_us(F&& f) {
+    using bench_clock = std::chrono::steady_clock;
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    auto const beg = bench_clock::now();
+    f();
+    auto const end = bench_clock::now();
+
+    return duration_cast<microseconds>(end - beg).count();
+}
+
+} //namespace test
+} //namespace boken
@@ -0,0 +1,176 @@
+#if !defined(BK_NO_TESTS)
+#include "catch.hpp"
+#include "format.hpp"
+#include "context.hpp"
+#include "item.hpp"
+#include "item_def.hpp"
+#include "names.hpp"
+#include "world.hpp"
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdint>
+
+TEST_CASE("static_string_buffer append") {
+    using namespace boken;
+
+    static_string_buffer<8> buffer;
+    REQUIRE(buffer.empty());
+    REQUIRE(!buffer.is_null());
+
+    REQUIRE(buffer.append("%d", 123));
+    REQUIRE(buffer.append("%s", "ab"));
+    REQUIRE(buffer.to_string_view() == string_view {"123ab"});
+
+    // truncated to fit
+    REQUIRE(!buffer.append("%s", "cdef"));
+    REQUIRE(buffer.full());
+    REQUIRE(buffer.to_string_view() == string_view {"123abcd"});
+
+    buffer.clear();
+    REQUIRE(buffer.empty());
+}
+
+TEST_CASE("null_string_buffer") {
+    using namespace boken;
+
+    null_string_buffer buffer;
+    REQUIRE(buffer.is_null());
+    REQUIRE(!buffer.append("%d", 123));
+    REQUIRE(buffer.empty());
+    REQUIRE(buffer.to_string_view().empty());
+
+    REQUIRE(!buffer.format("{} and {}", 123, "abc"));
+    REQUIRE(!buffer.write(123));
+    REQUIRE(buffer.empty());
+
+    buffer.clear();
+    REQUIRE(buffer.empty());
+}
+
+TEST_CASE("string_buffer_base format") {
+    using namespace boken;
+
+    static_string_buffer<128> buffer;
+
+    auto const check = [&](auto const& f, char const* const expected) {
+        buffer.clear();
+        f();
+        REQUIRE(buffer.to_string_view() == string_view {expected});
+    };
+
+    SECTION("integers") {
+        check([&] { buffer.write(0); }, "0");
+        check([&] { buffer.write(7, 42, -3); }, "742-3");
+        check([&] { buffer.write(uint8_t {255}, int16_t {-32768}); }, "255-32768");
+        check([&] { buffer.write(std::numeric_limits<int64_t>::min()); }
+          , "-9223372036854775808");
+        check([&] { buffer.write(std::numeric_limits<uint64_t>::max()); }
+          , "18446744073709551615");
+    }
+
+    SECTION("fixed point") {
+        check([&] { buffer.write(1.5); }, "1.50");
+        check([&] { buffer.write(fixed(-0.125, 1)); }, "-0.1");
+        check([&] { buffer.write(fixed(2.999, 2)); }, "3.00");
+        check([&] { buffer.write(fixed(3.0, 0)); }, "3");
+        check([&] { buffer.write(fixed(-0.001, 2)); }, "0.00");
+        check([&] { buffer.write(fixed(1.05, 3)); }, "1.050");
+    }
+
+    SECTION("hex") {
+        check([&] { buffer.write(hex(0)); }, "0x0");
+        check([&] { buffer.write(hex(0xBEEFu, 8)); }, "0x0000beef");
+    }
+
+    SECTION("strings") {
+        check([&] { buffer.write("a", 'b', string_view {"c"}, std::string {"d"}, true); }
+          , "abcdtrue");
+    }
+
+    SECTION("format string") {
+        check([&] { buffer.format("x = {}, y = {}.", 1, -2); }, "x = 1, y = -2.");
+        check([&] { buffer.format("{{}} {}", "a"); }, "{}} a");
+        check([&] { buffer.format("none"); }, "none");
+    }
+
+    SECTION("placeholder count") {
+        using detail::format_placeholder_count;
+
+        REQUIRE(format_placeholder_count("none") == 0);
+        REQUIRE(format_placeholder_count("{} and {}") == 2);
+        REQUIRE(format_placeholder_count("{{}} {}") == 1);
+        REQUIRE(format_placeholder_count("{{{}") == 1);
+        REQUIRE(format_placeholder_count("{x}") == -1);
+        REQUIRE(format_placeholder_count("trailing {") == -1);
+    }
+
+    SECTION("objects") {
+        auto const w = make_world();
+        item_deleter const deleter {*w};
+
+        item_definition def {"coin", item_id {1u}};
+        def.name = "coin";
+
+        item const itm {deleter, item_instance_id {1u}, item_id {1u}};
+
+        check([&] { buffer.format("a {} here", const_item_descriptor {itm, def}); }
+          , "a coin here");
+    }
+
+    SECTION("truncation") {
+        static_string_buffer<8> small;
+        REQUIRE(!small.format("{} {}", 1234, 5678));
+        REQUIRE(small.full());
+        REQUIRE(small.to_string_view() == string_view {"1234 56"});
+
+        null_string_buffer null;
+        REQUIRE(!null.format("{}", 1));
+    }
+}
+
+TEST_CASE("string_buffer_base format benchmark", "[.][benchmark]") {
+    using namespace boken;
+    using boken::test::time_us;
+
+    constexpr int n = 1000000;
+
+    static_string_buffer<256> buffer;
+
+    auto const run = [&](auto f) {
+        size_t size = 0;
+
+        auto const t = time_us([&] {
+            for (int i = 0; i < n; ++i) {
+                buffer.clear();
+                f(i);
+                size += buffer.size();
+            }
+        });
+
+        REQUIRE(size > 0u);
+        return t;
+    };
+
+    auto const t_printf = run([&](int const i) {
+        buffer.append("The %s hits the %s for %d damage (%d%% of %.2f).\n"
+          , "goblin", "player", i % 100, i % 7, 1.0 * i);
+    });
+
+    auto const t_format = run([&](int const i) {
+        buffer.format("The {} hits the {} for {} damage ({}% of {}).\n"
+          , "goblin", "player", i % 100, i % 7, 1.0 * i);
+    });
+
+    std::printf("string_buffer_base, %d messages:\n"
+                "  append (vsnprintf) : %" PRId64 " us (%" PRId64 " messages/s)\n"
+                "  format             : %" PRId64 " us (%" PRId64 " messages/s)\n"
+      , n
+      , t_printf, int64_t {n} * 1000000 / std::max(t_printf, int64_t {1})
+      , t_format, int64_t {n} * 1000000 / std::max(t_format, int64_t {1}));
+}
+
+#endif // !defined(BK_NO_TESTS)
@@ -0,0 +1,143 @@
+#if !defined(BK_NO_TESTS)
+#include "catch.hpp"
+#include "functional.hpp"
+#include "benchmark.hpp"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdint>
+
+namespace {
+
+struct test_a {};
+struct test_b {};
+
+int overload(boken::function_ref<test_a (int)>) { return 1; }
+int overload(boken::function_ref<test_b (int)>) { return 2; }
+
+//! Mimics the shape of the level interface: a virtual for_each over entities
+//! taking either a std::function or a function_ref.
+class entity_source {
+public:
+    using value_type = std::pair<uint32_t, int32_t>;
+
+    virtual ~entity_source() = default;
+
+    virtual void for_each_entity(
+        std::function<void (uint32_t, int32_t)> const& f) const = 0;
+
+    virtual void for_each_entity(
+        boken::function_ref<void (uint32_t, int32_t)> f) const = 0;
+};
+
+class entity_source_impl final : public entity_source {
+public:
+    explicit entity_source_impl(size_t const n) {
+        data_.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            data_.emplace_back(static_cast<uint32_t>(i + 1)
+                             , static_cast<int32_t>(i % 97));
+        }
+    }
+
+    void for_each_entity(
+        std::function<void (uint32_t, int32_t)> const& f
+    ) const final override {
+        for (auto const& e : data_) {
+            f(e.first, e.second);
+        }
+    }
+
+    void for_each_entity(
+        boken::function_ref<void (uint32_t, int32_t)> const f
+    ) const final override {
+        for (auto const& e : data_) {
+            f(e.first, e.second);
+        }
+    }
+private:
+    std::vector<value_type> data_;
+};
+
+} // namespace
+
+TEST_CASE("function_ref") {
+    using namespace boken;
+
+    SECTION("overload resolution by return type") {
+        REQUIRE(overload([](int) { return test_a {}; }) == 1);
+        REQUIRE(overload([](int) { return test_b {}; }) == 2);
+    }
+
+    SECTION("refers to, not copies, the callable") {
+        int n = 0;
+        auto const f = [&](int const i) { n += i; };
+
+        function_ref<void (int)> const r0 = f;
+        function_ref<void (int)> const r1 = r0;
+
+        r0(1);
+        r1(2);
+
+        REQUIRE(n == 3);
+    }
+
+    SECTION("result is discarded for void") {
+        int n = 0;
+        auto const f = [&](int const i) { return n += i; };
+        function_ref<void (int)> const r = f;
+        r(5);
+        REQUIRE(n == 5);
+    }
+}
+
+TEST_CASE("function_ref benchmark", "[.][benchmark]") {
+    using boken::test::time_us;
+
+    constexpr size_t entities   = 10000;
+    constexpr int    iterations = 1000;
+
+    entity_source_impl const impl {entities};
+    entity_source const& source = impl;
+
+    uint64_t sum_a = 0;
+    uint64_t sum_b = 0;
+    int64_t  dummy = 0;
+
+    // a capture larger than the small object buffer of most std::function
+    // implementations, as is typical for the lambdas in main.cpp
+    auto const run = [&](auto&& for_each) {
+        return time_us([&] {
+            for (int i = 0; i < iterations; ++i) {
+                for_each();
+            }
+        });
+    };
+
+    auto const t_function = run([&] {
+        source.for_each_entity(std::function<void (uint32_t, int32_t)> {
+            [&, i = &dummy, j = &sum_b](uint32_t const id, int32_t const p) {
+                sum_a += id + static_cast<uint32_t>(p) + static_cast<uint64_t>(*i + (j != nullptr));
+            }});
+    });
+
+    auto const t_function_ref = run([&] {
+        source.for_each_entity(boken::function_ref<void (uint32_t, int32_t)> {
+            [&, i = &dummy, j = &sum_a](uint32_t const id, int32_t const p) {
+                sum_b += id + static_cast<uint32_t>(p) + static_cast<uint64_t>(*i + (j != nullptr));
+            }});
+    });
+
+    REQUIRE(sum_a == sum_b);
+
+    std::printf("for_each_entity over %zu entities x %d:\n"
+                "  std::function : %" PRId64 " us\n"
+                "  function_ref  : %" PRId64 " us\n"
+      , entities, iterations, t_function, t_function_ref);
+}
+
+#endif // !defined(BK_NO_TESTS)
@@ -0,0 +1,176 @@
+#if !defined(BK_NO_TESTS)
+#include "catch.hpp"
+#include "inventory.hpp"
+#include "context.hpp"
+#include "data.hpp"
+#include "item.hpp"
+#include "item_def.hpp"
+#include "text.hpp"
+#include "tile.hpp"
+#include "world.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! An empty database; items without a definition fall back on their own
+//! properties.
+class empty_database final : public boken::game_database {
+public:
+    boken::item_definition const* find(boken::item_id) const noexcept final override {
+        return nullptr;
+    }
+
+    boken::entity_definition const* find(boken::entity_id) const noexcept final override {
+        return nullptr;
+    }
+
+    boken::string_view find(boken::item_property_id) const noexcept final override {
+        return {};
+    }
+
+    boken::string_view find(boken::entity_property_id) const noexcept final override {
+        return {};
+    }
+
+    boken::tile_map const& get_tile_map(boken::tile_map_type) const noexcept final override {
+        return tmap_;
+    }
+private:
+    boken::tile_map tmap_ {boken::tile_map_type::item, 0
+      , boken::sizei32x {18}, boken::sizei32y {18}
+      , boken::sizei32x {16}, boken::sizei32y {16}};
+};
+
+} // namespace
+
+TEST_CASE("inventory_list rows") {
+    using namespace boken;
+
+    auto const w       = make_world();
+    auto const trender = make_text_renderer();
+    empty_database const db;
+
+    auto const ctx = const_context {*w, db};
+    auto const property = item_property_id {1u};
+
+    auto const set_value = [&](item_instance_id const id, uint32_t const value) {
+        w->find(id).add_or_update_property(property, value);
+    };
+
+    // each item has a value, which is its only column
+    std::vector<unique_item> items;
+    auto const add_item = [&](uint32_t const value) {
+        items.push_back(w->create_object([&](item_instance_id const id) {
+            return item {w->get_item_deleter(), id, item_id {1u}};
+        }));
+
+        set_value(items.back().get(), value);
+        return items.back().get();
+    };
+
+    auto const value_of = [&](const_item_descriptor const i) {
+        return i.obj.property_value_or(db, property, 0u);
+    };
+
+    auto const il = make_inventory_list(ctx, *trender);
+    il->add_column(0, "value"
+      , [=](const_item_descriptor const i) { return std::to_string(value_of(i)); }
+      , [=](const_item_descriptor const i) { return int64_t {value_of(i)}; });
+
+    // the value of each row in order
+    auto const values = [&] {
+        std::vector<uint32_t> result;
+        for (int i = 0; i < static_cast<int>(il->rows()); ++i) {
+            result.push_back(value_of(const_item_descriptor {ctx, il->row_data(i)}));
+        }
+        return result;
+    };
+
+    for (auto const v : {3u, 1u, 4u, 1u, 5u, 9u}) {
+        il->add_row(add_item(v));
+    }
+
+    il->sort({-1});
+    REQUIRE(values() == (std::vector<uint32_t> {9, 5, 4, 3, 1, 1}));
+
+    SECTION("remove_rows takes sorted indices") {
+        il->selection_set({1});
+        REQUIRE(il->row_data(1) == items[4].get());
+
+        int const rows[] = {0, 2};
+        il->remove_rows(std::begin(rows), std::end(rows));
+
+        REQUIRE(values() == (std::vector<uint32_t> {5, 3, 1, 1}));
+        REQUIRE(il->row_data(0) == items[4].get());
+        REQUIRE(il->row_data(1) == items[0].get());
+
+        // the selection follows the row
+        auto const selection = il->get_selection();
+        REQUIRE(std::distance(selection.first, selection.second) == 1);
+        REQUIRE(*selection.first == 0);
+
+        // the order is kept by the rows added after
+        il->add_row(add_item(4u));
+        il->resort();
+        REQUIRE(values() == (std::vector<uint32_t> {5, 4, 3, 1, 1}));
+    }
+
+    SECTION("refresh looks only at the rows given") {
+        set_value(items[1].get(), 7u);
+        set_value(items[3].get(), 8u);
+
+        // items[1] is at row 4
+        int const unchanged[] = {0, 1, 2, 3};
+        REQUIRE(il->refresh(std::begin(unchanged), std::end(unchanged)) == 0);
+
+        int const changed[] = {4};
+        REQUIRE(il->refresh(std::begin(changed), std::end(changed)) == 1);
+        REQUIRE(il->refresh(std::begin(changed), std::end(changed)) == 0);
+
+        // only the refreshed row is moved into place
+        il->resort();
+        REQUIRE(values() == (std::vector<uint32_t> {9, 7, 5, 4, 3, 8}));
+    }
+
+    SECTION("resort gives the same order as sort") {
+        for (uint32_t i = 0; i < 40; ++i) {
+            il->add_row(add_item((i * 7u) % 11u));
+        }
+
+        il->sort({-1});
+
+        auto const check = [&] {
+            auto const resorted = values();
+            il->sort({-1});
+            REQUIRE(resorted == values());
+        };
+
+        // few enough changed rows to be moved one at a time
+        set_value(items[10].get(), 20u);
+        set_value(items[20].get(), 0u);
+        il->add_row(add_item(6u));
+
+        std::vector<int> rows(il->rows());
+        std::iota(begin(rows), end(rows), 0);
+        REQUIRE(il->refresh(rows.data(), rows.data() + rows.size()) == 2);
+
+        il->resort();
+        check();
+
+        // and enough to sort everything again
+        for (size_t i = 0; i < items.size(); i += 2) {
+            set_value(items[i].get(), static_cast<uint32_t>(i % 5u));
+        }
+
+        REQUIRE(il->refresh(rows.data(), rows.data() + rows.size()) > 0);
+
+        il->resort();
+        check();
+    }
+}
+
+#endif // !defined(BK_NO_TESTS)
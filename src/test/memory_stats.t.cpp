@@ -0,0 +1,41 @@
+#if !defined(BK_NO_TESTS)
+#include "catch.hpp"
+#include "memory_stats.hpp"
+
+TEST_CASE("memory_stats") {
+    using namespace boken;
+
+    REQUIRE(to_string(memory_tag::world)   == "world");
+    REQUIRE(to_string(memory_tag::pathing) == "pathing");
+    REQUIRE(to_string(memory_tag::data)    == "data");
+
+    if (!memory_stats_enabled()) {
+        auto const s = memory_stats(memory_tag::ui);
+        REQUIRE(s.current_bytes == 0u);
+        REQUIRE(s.peak_bytes    == 0u);
+        REQUIRE(s.allocations   == 0u);
+        return;
+    }
+
+    // the other tags can be in use by other tests
+    constexpr auto tag = memory_tag::pathing;
+
+    auto const before = memory_stats(tag);
+
+    {
+        tracked_vector<uint32_t, tag> v;
+        v.reserve(1000);
+
+        auto const s = memory_stats(tag);
+        REQUIRE(s.current_bytes == before.current_bytes + 1000 * sizeof(uint32_t));
+        REQUIRE(s.peak_bytes    >= s.current_bytes);
+        REQUIRE(s.allocations   == before.allocations + 1);
+    }
+
+    auto const after = memory_stats(tag);
+    REQUIRE(after.current_bytes == before.current_bytes);
+    REQUIRE(after.deallocations == before.deallocations + 1);
+    REQUIRE(after.peak_bytes    >= before.current_bytes + 1000 * sizeof(uint32_t));
+}
+
+#endif // !defined(BK_NO_TESTS)
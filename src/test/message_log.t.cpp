@@ -0,0 +1,152 @@
+#if !defined(BK_NO_TESTS)
+#include "catch.hpp"
+#include "message_log.hpp"
+#include "text.hpp"
+
+#include <string>
+
+TEST_CASE("message_log") {
+    using namespace boken;
+
+    auto const trender = make_text_renderer();
+    auto const log = make_message_log(*trender);
+
+    log->resize_to({point2i32 {}, sizei32x {500}, sizei32y {100}});
+
+    SECTION("print appends to the current message") {
+        log->print("a");
+        log->print("b");
+        log->println("c");
+        log->println("d");
+
+        REQUIRE(log->size() == 2u);
+        REQUIRE(log->message(0) == string_view {"abc"});
+        REQUIRE(log->message(1) == string_view {"d"});
+    }
+
+    SECTION("repeated messages are counted") {
+        log->println("a");
+        log->println("b");
+        log->println("b");
+        log->println("b");
+        log->println("a");
+
+        REQUIRE(log->size() == 3u);
+        REQUIRE(log->visible_size() == 3);
+        REQUIRE(log->visible_begin()[1].get().text() == string_view {"b (x3)"});
+    }
+
+    SECTION("batched messages are laid out when the batch ends") {
+        auto const v = log->version();
+
+        log->begin_batch();
+        log->println("a");
+        log->println("b");
+        log->println("b");
+
+        REQUIRE(log->version() == v);
+
+        log->end_batch();
+
+        REQUIRE(log->version() != v);
+        REQUIRE(log->size() == 2u);
+        REQUIRE(log->visible_size() == 2);
+        REQUIRE(log->visible_begin()[1].get().text() == string_view {"b (x2)"});
+        REQUIRE(log->visible_begin()[1].get().extent().y0
+             == log->visible_begin()[0].get().extent().y1);
+    }
+
+    SECTION("only visible messages are laid out") {
+        constexpr int n = 1000;
+        for (int i = 0; i < n; ++i) {
+            log->println("message " + std::to_string(i));
+        }
+
+        REQUIRE(log->size() == static_cast<size_t>(n));
+        REQUIRE(log->message(0) == string_view {"message 0"});
+
+        auto const h = value_cast(log->content_height());
+        REQUIRE(h > 100);
+
+        auto const count = log->visible_size();
+        REQUIRE(count > 0);
+        REQUIRE(count < 20);
+
+        // the most recent message is at the bottom of the window
+        auto const& last = log->visible_end()[-1].get();
+        REQUIRE(last.text() == string_view {"message 999"});
+        REQUIRE(value_cast(last.extent().y1) <= 100);
+        REQUIRE(value_cast(log->client_bounds().height()) <= 100);
+
+        // scrolled back to the oldest message
+        log->scroll_to(h);
+        REQUIRE(log->scroll_offset() == h - 100);
+        REQUIRE(log->visible_begin()[0].get().text() == string_view {"message 0"});
+        REQUIRE(value_cast(log->visible_begin()[0].get().extent().y0) == 0);
+
+        // new messages don't move those in view
+        log->println("new message");
+        REQUIRE(log->visible_begin()[0].get().text() == string_view {"message 0"});
+
+        // back to the most recent
+        log->scroll_by_messages(-(n + 1));
+        REQUIRE(log->scroll_offset() == 0);
+        REQUIRE(log->visible_end()[-1].get().text() == string_view {"new message"});
+
+        log->scroll_by_messages(1);
+        REQUIRE(log->visible_end()[-1].get().text() == string_view {"message 999"});
+    }
+
+    SECTION("heights are estimated until messages are shown") {
+        // no two words fit on a line together, so each message takes more
+        // lines than its length alone suggests
+        auto const word = std::string {"aaaaaaaaaaaaaaa "};
+
+        constexpr int n = 100;
+        for (int i = 0; i < n; ++i) {
+            log->println(word + word + word + std::to_string(i));
+        }
+
+        // the messages in view are laid out and their heights corrected; the
+        // rest are still estimated
+        auto const estimated = value_cast(log->content_height());
+
+        REQUIRE(log->visible_size() > 0);
+        auto const corrected = value_cast(log->content_height());
+        REQUIRE(corrected > estimated);
+
+        // the most recent message is still at the bottom of the window, and
+        // each message follows the one before it
+        auto const first = log->visible_begin();
+        auto const last  = log->visible_end();
+
+        REQUIRE(value_cast(last[-1].get().extent().y1) == 100);
+        for (auto it = first + 1; it != last; ++it) {
+            REQUIRE(it[0].get().extent().y0 == it[-1].get().extent().y1);
+        }
+
+        // a change of width makes every height an estimate again
+        log->resize_to({point2i32 {}, sizei32x {600}, sizei32y {100}});
+        log->resize_to({point2i32 {}, sizei32x {500}, sizei32y {100}});
+        REQUIRE(value_cast(log->content_height()) == estimated);
+
+        // scrolled back to the oldest message, which stays at the top of the
+        // window as the messages in view are corrected
+        log->scroll_to(estimated);
+        REQUIRE(log->visible_begin()[0].get().text() == log->message(0));
+        REQUIRE(value_cast(log->visible_begin()[0].get().extent().y0) == 0);
+        REQUIRE(value_cast(log->content_height()) > estimated);
+    }
+
+    SECTION("the oldest messages are discarded") {
+        constexpr int n = (1 << 16) + 10;
+        for (int i = 0; i < n; ++i) {
+            log->println(std::to_string(i));
+        }
+
+        REQUIRE(log->size() == size_t {1} << 16);
+        REQUIRE(log->message(0) == string_view {"10"});
+    }
+}
+
+#endif // !defined(BK_NO_TESTS)
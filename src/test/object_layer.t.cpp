@@ -0,0 +1,112 @@
+#if !defined(BK_NO_TESTS)
+#include "catch.hpp"
+
+#include "object_layer.hpp"
+
+#include <algorithm>
+
+TEST_CASE("object_layer") {
+    using namespace boken;
+
+    constexpr int32_t width  = 4;
+    constexpr int32_t height = 3;
+
+    using layer_t = object_layer<int, memory_tag::render>;
+    layer_t layer;
+    layer.reset(width, height);
+
+    // every object knows its tile, every tile knows the slot of its object,
+    // and no other tile has a slot.
+    auto const check = [&] {
+        REQUIRE(layer.data.size() == layer.tiles.size());
+
+        for (size_t i = 0; i < layer.tiles.size(); ++i) {
+            REQUIRE(layer.slot_at(layer.tiles[i]) == static_cast<int32_t>(i));
+        }
+
+        auto const used = std::count_if(begin(layer.slots), end(layer.slots)
+          , [](int32_t const slot) { return slot != layer_t::no_slot; });
+
+        REQUIRE(static_cast<size_t>(used) == layer.data.size());
+    };
+
+    // @returns the object at tile @p p, or -1 if there is none
+    auto const at = [&](point2i32 const p) {
+        auto const slot = layer.slot_at(layer.tile_index(p));
+        return slot == layer_t::no_slot
+          ? -1
+          : layer.data[static_cast<size_t>(slot)];
+    };
+
+    // objects are identified by the index of the tile they were added at
+    for (int32_t i = 0; i < 6; ++i) {
+        layer.insert(i, i);
+    }
+
+    check();
+    REQUIRE(layer.data.size() == 6u);
+    REQUIRE(at({1, 0}) == 1);
+    REQUIRE(at({1, 1}) == 5);
+    REQUIRE(at({3, 2}) == -1);
+
+    SECTION("erase from the middle") {
+        layer.erase(2);
+        check();
+
+        // the last object takes the place of the removed one
+        REQUIRE(layer.data.size() == 5u);
+        REQUIRE(layer.data[2] == 5);
+        REQUIRE(at({2, 0}) == -1);
+        REQUIRE(at({1, 1}) == 5);
+
+        // and the tile can be reused
+        layer.insert(2, 2);
+        check();
+        REQUIRE(at({2, 0}) == 2);
+    }
+
+    SECTION("erase the last and the first") {
+        layer.erase(5);
+        check();
+        layer.erase(0);
+        check();
+
+        REQUIRE(layer.data.size() == 4u);
+        REQUIRE(at({0, 0}) == -1);
+        REQUIRE(at({1, 0}) == 1);
+        REQUIRE(at({0, 1}) == 4);
+    }
+
+    SECTION("move") {
+        auto const to = layer.tile_index({3, 2});
+
+        layer.move(1, to);
+        check();
+        REQUIRE(at({1, 0}) == -1);
+        REQUIRE(at({3, 2}) == 1);
+
+        // to the same tile
+        layer.move(to, to);
+        check();
+        REQUIRE(at({3, 2}) == 1);
+
+        // a moved object is still erased by its new tile, and another can be
+        // inserted at its old one
+        layer.erase(to);
+        check();
+        layer.insert(1, 10);
+        check();
+
+        REQUIRE(at({3, 2}) == -1);
+        REQUIRE(at({1, 0}) == 10);
+    }
+
+    SECTION("reset") {
+        layer.reset(width, height);
+        check();
+        REQUIRE(layer.data.empty());
+        REQUIRE(at({0, 0}) == -1);
+    }
+}
+
+#endif // !defined(BK_NO_TESTS)
@@ -0,0 +1,67 @@
+#if !defined(BK_NO_TESTS)
+#include "catch.hpp"
+#include "render.hpp"
+#include "level.hpp"
+#include "random.hpp"
+#include "tile.hpp"
+#include "world.hpp"
+#include "benchmark.hpp"
+
+#include <vector>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdint>
+
+TEST_CASE("map_renderer update benchmark", "[.][benchmark]") {
+    using namespace boken;
+    using boken::test::time_us;
+    using update_t = map_renderer::update_t<entity_id>;
+
+    constexpr int32_t level_size = 200;
+    constexpr int32_t entities   = 5000;
+    constexpr int     turns      = 100;
+
+    auto const rng = make_random_state();
+    auto const w   = make_world();
+    auto const lvl = make_level(*rng, *w
+      , sizei32x {level_size}, sizei32y {level_size}, 0);
+
+    tile_map const tmap_base   {tile_map_type::base,   0, sizei32x {18}, sizei32y {18}, sizei32x {16}, sizei32y {16}};
+    tile_map const tmap_entity {tile_map_type::entity, 1, sizei32x {18}, sizei32y {18}, sizei32x {26}, sizei32y {17}};
+    tile_map const tmap_item   {tile_map_type::item,   2, sizei32x {18}, sizei32y {18}, sizei32x {16}, sizei32y {16}};
+
+    auto const r_map = make_map_renderer();
+    r_map->set_level(*lvl);
+    r_map->set_tile_maps({
+        {tile_map_type::base,   tmap_base}
+      , {tile_map_type::entity, tmap_entity}
+      , {tile_map_type::item,   tmap_item}});
+
+    // every entity starts on an even column and steps one column right on
+    // odd turns and back again on even turns.
+    std::vector<update_t> updates;
+    updates.reserve(static_cast<size_t>(entities));
+
+    for (int32_t i = 0; i < entities; ++i) {
+        auto const p = point2i32 {(i * 2) % level_size, (i * 2) / level_size};
+        r_map->add_object_at(p, entity_id {static_cast<uint32_t>(i + 1)});
+        updates.push_back({p, p + vec2i32 {1, 0}, entity_id {static_cast<uint32_t>(i + 1)}});
+    }
+
+    auto const t = time_us([&] {
+        for (int i = 0; i < turns; ++i) {
+            r_map->update_data(updates.data(), updates.data() + updates.size());
+
+            for (auto& u : updates) {
+                std::swap(u.prev_pos, u.next_pos);
+            }
+        }
+    });
+
+    std::printf("map_renderer::update_data %d entities, %d turns:\n"
+                "  total    : %" PRId64 " us\n"
+                "  per turn : %" PRId64 " us\n"
+      , entities, turns, t, t / turns);
+}
+
+#endif // !defined(BK_NO_TESTS)
@@ -0,0 +1,341 @@
+#if !defined(BK_NO_TESTS)
+#include "catch.hpp"
+#include "render_software.hpp"
+#include "level.hpp"
+#include "random.hpp"
+#include "text.hpp"
+#include "tile.hpp"
+#include "world.hpp"
+#include "benchmark.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdint>
+
+namespace {
+
+uint32_t pixel_at(boken::software_renderer const& r, int32_t const x, int32_t const y) {
+    auto const w = boken::value_cast(r.get_client_rect().width());
+    return r.framebuffer()[x + y * w];
+}
+
+boken::point2i16 p16(int const x, int const y) noexcept {
+    return {static_cast<int16_t>(x), static_cast<int16_t>(y)};
+}
+
+} // namespace
+
+TEST_CASE("software_renderer") {
+    using namespace boken;
+
+    constexpr uint32_t clear_color = 0xFF007F7Fu;
+    constexpr uint32_t red         = 0xFF0000FFu;
+    constexpr uint32_t blue        = 0xFFFF0000u;
+
+    auto const r = make_software_renderer(sizei32x {8}, sizei32y {8});
+    r->render_clear();
+
+    REQUIRE(r->get_client_rect() == recti32 {point2i32 {}, sizei32x {8}, sizei32y {8}});
+    REQUIRE(pixel_at(*r, 0, 0) == clear_color);
+    REQUIRE(pixel_at(*r, 7, 7) == clear_color);
+
+    SECTION("fill_rect") {
+        r->fill_rect({point2i32 {2, 2}, sizei32x {2}, sizei32y {3}}, red);
+
+        REQUIRE(pixel_at(*r, 1, 2) == clear_color);
+        REQUIRE(pixel_at(*r, 2, 2) == red);
+        REQUIRE(pixel_at(*r, 3, 4) == red);
+        REQUIRE(pixel_at(*r, 4, 4) == clear_color);
+        REQUIRE(pixel_at(*r, 3, 5) == clear_color);
+    }
+
+    SECTION("fill_rect blends") {
+        r->fill_rect({point2i32 {0, 0}, sizei32x {1}, sizei32y {1}}, red);
+        r->fill_rect({point2i32 {0, 0}, sizei32x {1}, sizei32y {1}}, 0x80FF0000u);
+
+        auto const p = pixel_at(*r, 0, 0);
+        REQUIRE(((p >>  0) & 0xFFu) == 0x7Fu); // R
+        REQUIRE(((p >> 16) & 0xFFu) == 0x80u); // B
+        REQUIRE(((p >> 24) & 0xFFu) == 0xFFu); // A
+    }
+
+    SECTION("scale and clip") {
+        auto const trans = r->transform({2.0f, 2.0f, 0.0f, 0.0f});
+        auto const clip  = r->clip_rect({point2i32 {0, 0}, sizei32x {3}, sizei32y {3}});
+
+        r->fill_rect({point2i32 {1, 1}, sizei32x {4}, sizei32y {4}}, red);
+
+        REQUIRE(pixel_at(*r, 1, 1) == clear_color);
+        REQUIRE(pixel_at(*r, 2, 2) == red);
+        REQUIRE(pixel_at(*r, 5, 5) == red);
+        REQUIRE(pixel_at(*r, 6, 6) == clear_color);
+    }
+
+    SECTION("render target and draw_tiles") {
+        auto const id = r->create_render_target(sizei32x {4}, sizei32y {2});
+
+        {
+            auto const target = r->render_target(id);
+            r->fill_rect({point2i32 {0, 0}, sizei32x {2}, sizei32y {2}}, 0xFFFFFFFFu);
+            r->fill_rect({point2i32 {2, 0}, sizei32x {2}, sizei32y {2}}, red);
+        }
+
+        // the window is untouched
+        REQUIRE(pixel_at(*r, 0, 0) == clear_color);
+
+        using ptr_t = read_only_pointer_t;
+
+        point2i16 const pos[] {p16(0, 0), p16(4, 6)};
+        point2i16 const tex[] {p16(0, 0), p16(2, 0)};
+        uint32_t  const col[] {blue, 0xFFFFFFFFu};
+
+        auto const trans = r->transform({1.0f, 1.0f, 1.0f, 0.0f});
+
+        r->draw_tiles(renderer2d::tile_params_uniform {
+            sizei32x {2}, sizei32y {2}, id, 2
+          , ptr_t {std::begin(pos), std::end(pos)}
+          , ptr_t {std::begin(tex), std::end(tex)}
+          , ptr_t {std::begin(col), std::end(col)}
+        });
+
+        // white modulated by blue, translated by 1
+        REQUIRE(pixel_at(*r, 0, 0) == clear_color);
+        REQUIRE(pixel_at(*r, 1, 0) == blue);
+        REQUIRE(pixel_at(*r, 2, 1) == blue);
+        REQUIRE(pixel_at(*r, 3, 1) == clear_color);
+
+        // red unmodulated
+        REQUIRE(pixel_at(*r, 5, 6) == red);
+        REQUIRE(pixel_at(*r, 6, 7) == red);
+        REQUIRE(pixel_at(*r, 7, 7) == clear_color);
+    }
+
+    SECTION("draw_rect") {
+        r->draw_rect({point2i32 {1, 1}, sizei32x {5}, sizei32y {5}}, 1, red);
+
+        REQUIRE(pixel_at(*r, 1, 1) == red);
+        REQUIRE(pixel_at(*r, 5, 5) == red);
+        REQUIRE(pixel_at(*r, 3, 1) == red);
+        REQUIRE(pixel_at(*r, 1, 3) == red);
+        REQUIRE(pixel_at(*r, 3, 3) == clear_color);
+        REQUIRE(pixel_at(*r, 6, 6) == clear_color);
+    }
+}
+
+TEST_CASE("frame_profiler") {
+    using namespace boken;
+
+    struct fill_task final : render_task {
+        void render(duration_t, renderer2d& r, view const&) final override {
+            recti32 const rects[] {
+                {point2i32 {0, 0}, sizei32x {1}, sizei32y {1}}
+              , {point2i32 {1, 1}, sizei32x {1}, sizei32y {1}}
+            };
+
+            r.fill_rects(std::begin(rects), std::end(rects), 0xFFFFFFFFu);
+            r.draw_rect(rects[0], 1, 0xFFFFFFFFu);
+        }
+
+        bool is_dirty() const noexcept final override {
+            return true;
+        }
+    };
+
+    auto const trender = make_text_renderer();
+    auto const renderer = make_game_renderer(
+        make_software_renderer(sizei32x {8}, sizei32y {8}), *trender);
+
+    renderer->add_task("a", std::make_unique<fill_task>(), 0);
+    renderer->add_task("b", std::make_unique<fill_task>(), 0);
+
+    auto const& profiler = renderer->profiler();
+    REQUIRE(profiler.frame_count() == 0);
+
+    renderer->render(render_task::duration_t {}, view {});
+    renderer->render(render_task::duration_t {}, view {});
+
+    REQUIRE(profiler.frame_count() == 2);
+    REQUIRE(std::distance(profiler.begin(), profiler.end()) == 2);
+
+    for (auto const& p : profiler) {
+        REQUIRE(p.stats.draw_tiles_calls == 0);
+        REQUIRE(p.stats.rects_filled == 2);
+        REQUIRE(p.stats.rects_drawn == 1);
+        REQUIRE(p.cpu_time >= render_task::duration_t {});
+    }
+
+    REQUIRE(profiler.begin()[0].id == string_view {"a"});
+    REQUIRE(profiler.begin()[1].id == string_view {"b"});
+}
+
+TEST_CASE("game_renderer dirty tracking") {
+    using namespace boken;
+
+    struct counting_task final : render_task {
+        void render(duration_t, renderer2d&, view const&) final override {
+            ++renders;
+            dirty = false;
+        }
+
+        bool is_dirty() const noexcept final override {
+            return dirty;
+        }
+
+        int  renders = 0;
+        bool dirty   = true;
+    };
+
+    auto const trender = make_text_renderer();
+    auto const renderer = make_game_renderer(
+        make_software_renderer(sizei32x {8}, sizei32y {8}), *trender);
+
+    auto& task = renderer->add_task("task", std::make_unique<counting_task>(), 0);
+
+    auto const delta = render_task::duration_t {};
+    view v;
+
+    // the first frame is always rendered
+    REQUIRE(renderer->is_dirty());
+    REQUIRE(renderer->render(delta, v));
+    REQUIRE(task.renders == 1);
+
+    // nothing has changed
+    REQUIRE(!renderer->is_dirty());
+    REQUIRE(!renderer->render(delta, v));
+    REQUIRE(task.renders == 1);
+
+    // the task has changed
+    task.dirty = true;
+    REQUIRE(renderer->render(delta, v));
+    REQUIRE(task.renders == 2);
+
+    // the view has changed
+    v.set_offset(1.0f, 0.0f);
+    REQUIRE(renderer->render(delta, v));
+    REQUIRE(task.renders == 3);
+    REQUIRE(!renderer->render(delta, v));
+
+    // an unchanged copy is the same view; one set to the same values isn't
+    auto const copy = v;
+    REQUIRE(!renderer->render(delta, copy));
+
+    view other;
+    other.set_offset(1.0f, 0.0f);
+    REQUIRE(renderer->render(delta, other));
+    REQUIRE(task.renders == 4);
+    REQUIRE(renderer->render(delta, v));
+    REQUIRE(task.renders == 5);
+
+    // explicitly invalidated
+    renderer->invalidate();
+    REQUIRE(renderer->render(delta, v));
+    REQUIRE(task.renders == 6);
+}
+
+TEST_CASE("map_renderer redraws its chunks after a render target reset") {
+    using namespace boken;
+
+    constexpr int32_t level_size = 64;
+
+    auto const rng     = make_random_state();
+    auto const w       = make_world();
+    auto const lvl     = make_level(*rng, *w
+      , sizei32x {level_size}, sizei32y {level_size}, 0);
+    auto const trender = make_text_renderer();
+
+    tile_map const tmap_base   {tile_map_type::base,   0, sizei32x {18}, sizei32y {18}, sizei32x {16}, sizei32y {16}};
+    tile_map const tmap_entity {tile_map_type::entity, 1, sizei32x {18}, sizei32y {18}, sizei32x {26}, sizei32y {17}};
+    tile_map const tmap_item   {tile_map_type::item,   2, sizei32x {18}, sizei32y {18}, sizei32x {16}, sizei32y {16}};
+
+    auto renderer = make_game_renderer(
+        make_software_renderer(sizei32x {256}, sizei32y {256}), *trender);
+
+    auto& r_map = renderer->add_task("map", make_map_renderer(), 0);
+    r_map.set_level(*lvl);
+    r_map.set_tile_maps({
+        {tile_map_type::base,   tmap_base}
+      , {tile_map_type::entity, tmap_entity}
+      , {tile_map_type::item,   tmap_item}});
+    r_map.update_map_data();
+
+    // the draw calls made by the map for a frame
+    auto const draw_calls = [&] {
+        REQUIRE(renderer->render(render_task::duration_t {}, view {}));
+        return renderer->profiler().begin()[0].stats.draw_tiles_calls;
+    };
+
+    // the first frame draws every chunk; later ones only blit them
+    auto const first = draw_calls();
+    renderer->invalidate();
+    auto const cached = draw_calls();
+    REQUIRE(cached < first);
+
+    // a reset is the same as the first frame
+    r_map.reset_render_targets();
+    REQUIRE(renderer->is_dirty());
+    REQUIRE(draw_calls() == first);
+
+    renderer->invalidate();
+    REQUIRE(draw_calls() == cached);
+}
+
+TEST_CASE("software_renderer frame time benchmark", "[.][benchmark]") {
+    using namespace boken;
+    using boken::test::time_us;
+
+    constexpr int32_t level_size = 200;
+    constexpr int32_t win_w      = 1024;
+    constexpr int32_t win_h      = 768;
+    constexpr int     frames     = 120;
+
+    auto const rng     = make_random_state();
+    auto const w       = make_world();
+    auto const lvl     = make_level(*rng, *w
+      , sizei32x {level_size}, sizei32y {level_size}, 0);
+    auto const trender = make_text_renderer();
+
+    tile_map const tmap_base   {tile_map_type::base,   0, sizei32x {18}, sizei32y {18}, sizei32x {16}, sizei32y {16}};
+    tile_map const tmap_entity {tile_map_type::entity, 1, sizei32x {18}, sizei32y {18}, sizei32x {26}, sizei32y {17}};
+    tile_map const tmap_item   {tile_map_type::item,   2, sizei32x {18}, sizei32y {18}, sizei32x {16}, sizei32y {16}};
+
+    auto  sr       = make_software_renderer(sizei32x {win_w}, sizei32y {win_h});
+    auto& software = *sr;
+    auto  renderer = make_game_renderer(std::move(sr), *trender);
+
+    auto& r_map = renderer->add_task("map", make_map_renderer(), 0);
+    r_map.set_level(*lvl);
+    r_map.set_tile_maps({
+        {tile_map_type::base,   tmap_base}
+      , {tile_map_type::entity, tmap_entity}
+      , {tile_map_type::item,   tmap_item}});
+    r_map.update_map_data();
+
+    // pan diagonally across the level, zooming out half way
+    auto const camera = [&](int const frame) noexcept {
+        auto const t = static_cast<float>(frame) / static_cast<float>(frames);
+
+        auto const scale = (t < 0.5f) ? 1.0f : 0.5f;
+
+        view v;
+        v.set_scale(scale, scale);
+        v.set_offset(-t * static_cast<float>(level_size * 18 - win_w)
+                   , -t * static_cast<float>(level_size * 18 - win_h));
+
+        return v;
+    };
+
+    auto const t = time_us([&] {
+        for (int i = 0; i < frames; ++i) {
+            renderer->render(render_task::duration_t {}, camera(i));
+        }
+    });
+
+    REQUIRE(software.frame_count() == frames);
+
+    std::printf("game_renderer::render (software) %dx%d level, %d frames:\n"
+                "  total     : %" PRId64 " us\n"
+                "  per frame : %" PRId64 " us\n"
+      , level_size, level_size, frames, t, t / frames);
+}
+
+#endif // !defined(BK_NO_TESTS)
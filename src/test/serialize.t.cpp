@@ -0,0 +1,228 @@
+#if !defined(BK_NO_TESTS)
+#include "catch.hpp"
+#include "serialize.hpp"
+#include "item_def.hpp"
+#include "entity_def.hpp"
+#include "render.hpp"
+#include "render_software.hpp"
+#include "text.hpp"
+#include "benchmark.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+
+TEST_CASE("definition cache") {
+    using namespace boken;
+
+    constexpr char const* item_file   = "./definition_cache_test_items.dat";
+    constexpr char const* entity_file = "./definition_cache_test_entities.dat";
+    constexpr char const* cache_file  = "./definition_cache_test.cache";
+
+    auto const write_file = [](char const* const filename, char const* const text) {
+        auto const handle = fopen(filename, "wb");
+        REQUIRE(!!handle);
+        fputs(text, handle);
+        fclose(handle);
+    };
+
+    auto const items_json =
+        R"({"type": "items", "data": {)"
+        R"(  "coin":  {"name": "coin",  "properties": {"weight": 10, "stack_size": -1}},)"
+        R"(  "dagger": {"name": "dagger", "properties": {"weight": 1.5, "type": "weapon"}})"
+        R"(}})";
+
+    auto const entities_json =
+        R"({"type": "entities", "data": {)"
+        R"(  "rat": {"name": "rat", "properties": {"tile_index": 3, "flags": [true, false]}})"
+        R"(}})";
+
+    write_file(item_file, items_json);
+    write_file(entity_file, entities_json);
+    std::remove(cache_file);
+
+    // everything the callbacks see, in order; items and entities are loaded
+    // concurrently, so each has its own log.
+    std::vector<std::string> item_log;
+    std::vector<std::string> entity_log;
+
+    auto const on_property = [](std::vector<std::string>& log) {
+        return [&log](string_view const name, uint32_t const hash
+                    , serialize_data_type const type, uint32_t const value) {
+            log.push_back("property " + name.to_string()
+              + " " + std::to_string(hash)
+              + " " + std::to_string(static_cast<uint32_t>(type))
+              + " " + std::to_string(value));
+            return true;
+        };
+    };
+
+    auto const on_finish = [](std::vector<std::string>& log) {
+        return [&log](auto const& def) {
+            std::string s = "definition " + def.id_string + " " + def.name
+              + " " + std::to_string(value_cast(def.id));
+
+            for (auto const& p : def.properties) {
+                s += " " + std::to_string(value_cast(p.first))
+                   + "=" + std::to_string(p.second);
+            }
+
+            log.push_back(s);
+        };
+    };
+
+    std::vector<std::string> log;
+
+    auto const load = [&] {
+        item_log.clear();
+        entity_log.clear();
+
+        auto const result = load_definitions(item_file, entity_file, cache_file
+          , on_finish(item_log),   on_property(item_log)
+          , on_finish(entity_log), on_property(entity_log));
+
+        log = item_log;
+        log.insert(log.end(), entity_log.begin(), entity_log.end());
+
+        return result;
+    };
+
+    auto const cleanup = [&] {
+        std::remove(item_file);
+        std::remove(entity_file);
+        std::remove(cache_file);
+    };
+
+    // no cache yet
+    REQUIRE(load() == definition_source::original);
+    auto const expected = log;
+    REQUIRE(expected.size() == 11u);
+
+    // the cache reproduces what was parsed
+    REQUIRE(load() == definition_source::cache);
+    REQUIRE(log == expected);
+
+    // a changed definition file makes the cache stale
+    write_file(item_file, items_json);
+    auto const f = fopen(item_file, "ab");
+    fputs("\n", f);
+    fclose(f);
+
+    REQUIRE(load() == definition_source::original);
+    REQUIRE(log == expected);
+    REQUIRE(load() == definition_source::cache);
+
+    // a damaged cache is ignored, and rebuilt
+    write_file(cache_file, "BKDB");
+    REQUIRE(load() == definition_source::original);
+    REQUIRE(log == expected);
+    REQUIRE(load() == definition_source::cache);
+
+    // a definition file that can't be parsed is an error, and the cache is
+    // left as it was; it was built from the file with a trailing newline.
+    write_file(item_file, R"({"type": "items", "data": {)");
+    REQUIRE(load() == definition_source::failed);
+    write_file(item_file, (std::string {items_json} + "\n").c_str());
+    REQUIRE(load() == definition_source::cache);
+    REQUIRE(log == expected);
+
+    // a rejected property is an error; the files aren't parsed instead
+    auto const reject = [](string_view, uint32_t, serialize_data_type, uint32_t) {
+        return false;
+    };
+
+    item_log.clear();
+    entity_log.clear();
+    REQUIRE(load_definitions(item_file, entity_file, cache_file
+      , on_finish(item_log),   reject
+      , on_finish(entity_log), on_property(entity_log))
+        == definition_source::failed);
+    REQUIRE(item_log.empty());
+
+    cleanup();
+}
+
+TEST_CASE("startup benchmark", "[.][benchmark]") {
+    using namespace boken;
+    using boken::test::time_us;
+
+    // the game's own data; the cache is kept apart from the game's
+    constexpr char const* item_file   = "./data/items.dat";
+    constexpr char const* entity_file = "./data/entities.dat";
+    constexpr char const* cache_file  = "./startup_benchmark.cache";
+
+    std::remove(cache_file);
+
+    // items and entities are loaded concurrently, so each has its own count
+    int64_t item_defs   = 0;
+    int64_t entity_defs = 0;
+
+    auto const on_property = [](string_view, uint32_t, serialize_data_type, uint32_t) {
+        return true;
+    };
+
+    auto const on_item   = [&](item_definition const&)   { ++item_defs; };
+    auto const on_entity = [&](entity_definition const&) { ++entity_defs; };
+
+    auto const load = [&](definition_source const expected) {
+        item_defs   = 0;
+        entity_defs = 0;
+
+        auto result = definition_source {};
+        auto const t = time_us([&] {
+            result = load_definitions(item_file, entity_file, cache_file
+              , on_item, on_property, on_entity, on_property);
+        });
+
+        REQUIRE(result == expected);
+        REQUIRE(item_defs > 0);
+        REQUIRE(entity_defs > 0);
+
+        return t;
+    };
+
+    auto const t_parse = load(definition_source::original);
+    auto const parsed  = std::make_pair(item_defs, entity_defs);
+    auto const t_cache = load(definition_source::cache);
+    REQUIRE(std::make_pair(item_defs, entity_defs) == parsed);
+
+    std::remove(cache_file);
+
+    std::printf("startup, %" PRId64 " items and %" PRId64 " entities:\n"
+                "  definitions (parse, rebuild cache) : %" PRId64 " us\n"
+                "  definitions (from cache)           : %" PRId64 " us\n"
+      , item_defs, entity_defs, t_parse, t_cache);
+
+    // each atlas on its own; the renderer loads them concurrently
+    for (auto const filename : {"./data/tiles.bmp"
+                              , "./data/entities.bmp"
+                              , "./data/background.bmp"}
+    ) {
+        bool ok = false;
+        auto const t = time_us([&] { ok = decode_texture_atlas(filename); });
+
+        std::printf("  atlas %-28s : %" PRId64 " us%s\n"
+          , filename, t, ok ? "" : " (missing)");
+    }
+
+    // the renderer, including its atlases, and the text renderer
+    std::unique_ptr<text_renderer> trender;
+    std::unique_ptr<game_renderer> renderer;
+
+    auto const t_renderer = time_us([&] {
+        trender  = make_text_renderer();
+        renderer = make_game_renderer(
+            make_software_renderer(sizei32x {1024}, sizei32y {768}), *trender);
+    });
+
+    REQUIRE(!!renderer);
+
+    std::printf("  renderer setup                     : %" PRId64 " us\n"
+      , t_renderer);
+}
+
+#endif // !defined(BK_NO_TESTS)
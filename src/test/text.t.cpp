@@ -0,0 +1,260 @@
+#if !defined(BK_NO_TESTS)
+#include "catch.hpp"
+#include "text.hpp"
+
+#include <algorithm>
+
+namespace {
+
+//! A text_renderer which places each glyph at a location determined by the
+//! current generation, and counts the glyphs loaded and touched.
+class counting_text_renderer final : public boken::text_renderer {
+public:
+    using sizei32x = boken::sizei32x;
+    using sizei32y = boken::sizei32y;
+
+    glyph_data_t load_metrics(uint32_t, uint32_t const cp) noexcept final override {
+        return load_metrics(cp);
+    }
+
+    glyph_data_t load_metrics(uint32_t const cp) noexcept final override {
+        ++loads;
+
+        // as though loading cp moved every glyph loaded before it
+        if (cp == evict_on) {
+            evict_on = 0;
+            ++gen;
+        }
+
+        auto const x = static_cast<int16_t>(cp % 16u);
+        auto const y = static_cast<int16_t>(gen);
+
+        return {{x, y}, {int16_t {1}, int16_t {1}}, {}, {int16_t {1}, int16_t {0}}};
+    }
+
+    void touch(uint32_t const* const first, uint32_t const* const last) noexcept final override {
+        touches += static_cast<int>(last - first);
+    }
+
+    int pixel_size() const noexcept final override { return 1; }
+    int ascender()   const noexcept final override { return 1; }
+    int descender()  const noexcept final override { return 0; }
+    int line_gap()   const noexcept final override { return 1; }
+
+    int glyph_advance() const noexcept final override { return 1; }
+
+    uint32_t generation() const noexcept final override { return gen; }
+
+    sizei32x atlas_width()  const noexcept final override { return 16; }
+    sizei32y atlas_height() const noexcept final override { return 16; }
+
+    uint32_t atlas_texture() const noexcept final override { return no_texture; }
+    void set_atlas_texture(uint32_t) noexcept final override {}
+
+    std::vector<glyph_copy_t> const& pending_copies() const noexcept final override {
+        return copies;
+    }
+
+    void clear_pending_copies() noexcept final override {}
+
+    void recopy_atlas() final override {}
+
+    std::vector<glyph_copy_t> copies;
+
+    uint32_t gen      = 0;
+    uint32_t evict_on = 0;
+    int      loads    = 0;
+    int      touches  = 0;
+};
+
+} // namespace
+
+TEST_CASE("text_layout update") {
+    using namespace boken;
+
+    counting_text_renderer trender;
+    text_layout const text {trender, "abc"};
+
+    REQUIRE(trender.loads == 3);
+    REQUIRE(text.data().size() == 3u);
+
+    // the atlas hasn't changed; the glyphs are only touched
+    text.update(trender);
+    text.update(trender);
+    REQUIRE(trender.loads == 3);
+    REQUIRE(trender.touches == 6);
+
+    // the atlas changed; every glyph is reloaded once
+    trender.gen = 1;
+    text.update(trender);
+    REQUIRE(trender.loads == 6);
+
+    for (auto const& glyph : text.data()) {
+        REQUIRE(value_cast(glyph.texture.y) == 1);
+    }
+
+    text.update(trender);
+    REQUIRE(trender.loads == 6);
+}
+
+TEST_CASE("text_layout update with an eviction part way through") {
+    using namespace boken;
+
+    counting_text_renderer trender;
+    text_layout const text {trender, "abc"};
+
+    // reloading b moves a, which was reloaded just before it
+    trender.gen      = 1;
+    trender.evict_on = 'b';
+    text.update(trender);
+
+    REQUIRE(trender.gen == 2u);
+    REQUIRE(trender.loads == 9);
+
+    for (auto const& glyph : text.data()) {
+        REQUIRE(value_cast(glyph.texture.y) == 2);
+    }
+}
+
+TEST_CASE("text_layout utf8") {
+    using namespace boken;
+
+    counting_text_renderer trender;
+
+    // a, e with acute accent, invalid byte, b
+    text_layout const text {trender, "a\xC3\xA9\xFF" "b"};
+
+    std::vector<uint32_t> cps;
+    for (auto const& glyph : text.data()) {
+        cps.push_back(glyph.codepoint);
+    }
+
+    REQUIRE((cps == std::vector<uint32_t> {'a', 0xE9u, 0xFFFDu, 'b'}));
+}
+
+TEST_CASE("estimate_text_width") {
+    using namespace boken;
+
+    counting_text_renderer trender;
+
+    auto const estimate = [&](char const* const s, int16_t const max_w) {
+        return value_cast(estimate_text_width(trender, s, sizei16x {max_w}));
+    };
+
+    // the same as the width of the laid out text
+    for (auto const s : {"", "abc", "a\xC3\xA9\xFF" "b"}) {
+        text_layout const text {trender, s};
+        REQUIRE(estimate(s, 100) == value_cast(text.extent().width()));
+    }
+
+    REQUIRE(trender.loads == 7);
+
+    // but no wider than the maximum
+    REQUIRE(estimate("abcdef", 4) == 4);
+    REQUIRE(trender.loads == 7);
+}
+
+TEST_CASE("text_renderer glyph atlas") {
+    using namespace boken;
+
+    // room for exactly four glyphs
+    auto const trender = make_text_renderer(sizei32x {36}, sizei32y {36});
+
+    auto const load = [&](uint32_t const cp) {
+        return trender->load_metrics(cp).texture;
+    };
+
+    auto const gen = trender->generation();
+
+    auto const a = load('a');
+    auto const b = load('b');
+    auto const c = load('c');
+    auto const d = load('d');
+
+    // placing glyphs doesn't move any others
+    REQUIRE(trender->generation() == gen);
+    REQUIRE(trender->pending_copies().size() == 4u);
+    REQUIRE(a != b);
+    REQUIRE(a != c);
+    REQUIRE(a != d);
+    REQUIRE(b != c);
+    REQUIRE(b != d);
+    REQUIRE(c != d);
+
+    // glyphs are copied from their cell in the font texture
+    auto const& copy = trender->pending_copies()[0];
+    REQUIRE(copy.dest == a);
+    REQUIRE(value_cast(copy.source.x) == 18 * ('a' % 16));
+    REQUIRE(value_cast(copy.source.y) == 18 * ('a' / 16));
+
+    trender->clear_pending_copies();
+
+    // already resident
+    REQUIRE(load('a') == a);
+    REQUIRE(trender->pending_copies().empty());
+
+    // the atlas is full; b is the least recently used
+    REQUIRE(load('e') == b);
+    REQUIRE(trender->generation() != gen);
+    REQUIRE(trender->pending_copies().size() == 1u);
+
+    REQUIRE(load('a') == a);
+    REQUIRE(load('c') == c);
+    REQUIRE(load('d') == d);
+    REQUIRE(load('e') == b);
+
+    // the font texture uses code page 437
+    trender->clear_pending_copies();
+    load(0xE9u);
+
+    REQUIRE(trender->pending_copies().size() == 1u);
+    REQUIRE(value_cast(trender->pending_copies()[0].source.x) == 18 * (0x82 % 16));
+    REQUIRE(value_cast(trender->pending_copies()[0].source.y) == 18 * (0x82 / 16));
+
+    // after the atlas is lost, every resident glyph is copied again in place;
+    // every location in the atlas is in use
+    auto const gen_full = trender->generation();
+
+    trender->clear_pending_copies();
+    trender->recopy_atlas();
+
+    auto const& copies = trender->pending_copies();
+    REQUIRE(copies.size() == 4u);
+    REQUIRE(trender->generation() == gen_full);
+
+    auto const is_copied = [&](point2i16 const p) {
+        return std::any_of(begin(copies), end(copies)
+          , [p](text_renderer::glyph_copy_t const& c) noexcept { return c.dest == p; });
+    };
+
+    REQUIRE(is_copied(a));
+    REQUIRE(is_copied(b));
+    REQUIRE(is_copied(c));
+    REQUIRE(is_copied(d));
+}
+
+TEST_CASE("text_renderer evicts glyphs which aren't drawn") {
+    using namespace boken;
+
+    // room for exactly four glyphs
+    auto const trender = make_text_renderer(sizei32x {36}, sizei32y {36});
+
+    // loaded once, but drawn every frame
+    text_layout const text {*trender, "abba"};
+    auto const a = text.data()[0].texture;
+    auto const b = text.data()[1].texture;
+
+    auto const c = trender->load_metrics('c').texture;
+    trender->load_metrics('d');
+
+    // drawing the text makes a and b more recently used than c and d
+    text.update(*trender);
+    REQUIRE(trender->load_metrics('e').texture == c);
+
+    // nothing drawn has moved
+    text.update(*trender);
+    REQUIRE(text.data()[0].texture == a);
+    REQUIRE(text.data()[1].texture == b);
+}
+
+#endif // !defined(BK_NO_TESTS)
@@ -2,10 +2,14 @@
 #include "catch.hpp"
 #include "unicode.hpp"
 #include "config.hpp" // string_view
+#include "benchmark.hpp"
 
 #include <algorithm>
+#include <string>
 #include <vector>
 #include <numeric>
+#include <cinttypes>
+#include <cstdio>
 
 TEST_CASE("unicode (ascii)") {
     boken::string_view s {"test"};
@@ -39,4 +43,104 @@ TEST_CASE("unicode single kanji") {
     REQUIRE(cp == 0x4E9C);
 }
 
+TEST_CASE("unicode decode") {
+    using namespace boken;
+
+    auto const decode_iterator = [](std::string const& s) {
+        std::vector<uint32_t> result;
+        for (utf8_decoder_iterator it {s.c_str()}; it && it != utf8_decoder_iterator {}; ++it) {
+            result.push_back(*it);
+        }
+        return result;
+    };
+
+    auto const decode_bulk = [](std::string const& s, bool& valid) {
+        std::vector<uint32_t> result;
+        auto const last = s.data() + s.size();
+        valid = decode(s.data(), last, back_inserter(result)) == last;
+        return result;
+    };
+
+    bool valid = false;
+
+    SECTION("matches the iterator") {
+        char const* const strings[] {
+            ""
+          , "a"
+          , "long enough to take the fast path at least twice"
+          , "\xE4\xBA\x9C"
+          , "mixed \xE4\xBA\x9C text with \xC3\xA9 accents \xF0\x9F\x98\x80 and more"
+          , "12345678\xC3\xA9"
+          , "1234567\xC3\xA9"
+        };
+
+        for (auto const str : strings) {
+            auto const s = std::string {str};
+            REQUIRE(decode_bulk(s, valid) == decode_iterator(s));
+            REQUIRE(valid);
+
+            REQUIRE(code_point_count(s.data(), s.data() + s.size())
+                 == decode_iterator(s).size());
+        }
+    }
+
+    SECTION("invalid") {
+        char const* const strings[] {
+            "abcdefgh\xFF"
+          , "\xC3"
+          , "abc\xC3\x41"
+          , "0123456789\xE4\xBA"
+          , "\xED\xA0\x80" // surrogate
+          , "\xC0\xAF"      // overlong
+        };
+
+        for (auto const str : strings) {
+            auto const s = std::string {str};
+            auto const result = decode_bulk(s, valid);
+            REQUIRE(!valid);
+
+            // everything up to the invalid sequence is decoded the same way
+            auto const expected = decode_iterator(s);
+            REQUIRE(std::equal(begin(result), end(result), begin(expected)));
+        }
+    }
+}
+
+TEST_CASE("unicode decode benchmark", "[.][benchmark]") {
+    using namespace boken;
+    using boken::test::time_us;
+
+    constexpr int iterations = 1000;
+
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        text += "You hit the goblin with a rusty sword. ";
+    }
+
+    std::vector<uint32_t> out;
+    out.reserve(text.size());
+
+    auto const t_iterator = time_us([&] {
+        for (int i = 0; i < iterations; ++i) {
+            out.clear();
+            std::copy(utf8_decoder_iterator {text.c_str()}, utf8_decoder_iterator {}
+              , back_inserter(out));
+        }
+    });
+
+    auto const t_decode = time_us([&] {
+        for (int i = 0; i < iterations; ++i) {
+            out.clear();
+            decode(text.data(), text.data() + text.size(), back_inserter(out));
+        }
+    });
+
+    REQUIRE(out.size() == text.size());
+
+    std::printf("utf8 decode %d bytes, %d iterations:\n"
+                "  utf8_decoder_iterator : %" PRId64 " us\n"
+                "  decode                : %" PRId64 " us\n"
+      , static_cast<int>(text.size()), iterations, t_iterator, t_decode);
+}
+
 #endif // !defined(BK_NO_TESTS)
@@ -1,27 +1,183 @@
 #include "text.hpp"
 #include "system.hpp"   // for system
+#include "unicode.hpp"  // for utf8_decoder_iterator
 #include "utility.hpp"  // for BK_OFFSETOF
 #include "math.hpp"
 
 #include <algorithm>    // for move, max, swap
 #include <array>
+#include <unordered_map>
 
 namespace boken {
 
 namespace {
 
-template <typename FwdIt>
-uint32_t next_code_point(FwdIt& it, FwdIt const last) noexcept {
-    if (it == last) {
-        return 0u;
+//! Decode the UTF-8 text @p s to @p out; each byte which doesn't begin a
+//! valid sequence is decoded as U+FFFD.
+template <typename Container>
+void decode_text(string_view const s, Container& out) {
+    out.clear();
+    out.reserve(s.size());
+
+    auto       it   = s.data();
+    auto const last = s.data() + s.size();
+
+    while ((it = decode(it, last, back_inserter(out))) != last) {
+        out.push_back(0xFFFDu);
+        ++it;
     }
+}
 
-    auto result = *it;
-    ++it;
+//! the size of every glyph in the font texture, which is a grid of
+//! glyphs_per_row x glyphs_per_row glyphs.
+constexpr int16_t  glyph_size     = 18;
+constexpr uint32_t glyphs_per_row = 16u;
 
-    return static_cast<uint8_t>(result);
+//! @returns the index of the glyph for @p cp in the font texture, which uses
+//! code page 437. Code points with no equivalent map to '?'.
+uint32_t glyph_index(uint32_t const cp) noexcept {
+    if (cp < 0x80u) {
+        return cp;
+    }
+
+    static constexpr std::array<uint16_t, 128> cp437 {{
+        0x00C7, 0x00FC, 0x00E9, 0x00E2, 0x00E4, 0x00E0, 0x00E5, 0x00E7
+      , 0x00EA, 0x00EB, 0x00E8, 0x00EF, 0x00EE, 0x00EC, 0x00C4, 0x00C5
+      , 0x00C9, 0x00E6, 0x00C6, 0x00F4, 0x00F6, 0x00F2, 0x00FB, 0x00F9
+      , 0x00FF, 0x00D6, 0x00DC, 0x00A2, 0x00A3, 0x00A5, 0x20A7, 0x0192
+      , 0x00E1, 0x00ED, 0x00F3, 0x00FA, 0x00F1, 0x00D1, 0x00AA, 0x00BA
+      , 0x00BF, 0x2310, 0x00AC, 0x00BD, 0x00BC, 0x00A1, 0x00AB, 0x00BB
+      , 0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556
+      , 0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510
+      , 0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F
+      , 0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567
+      , 0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B
+      , 0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580
+      , 0x03B1, 0x00DF, 0x0393, 0x03C0, 0x03A3, 0x03C3, 0x00B5, 0x03C4
+      , 0x03A6, 0x0398, 0x03A9, 0x03B4, 0x221E, 0x03C6, 0x03B5, 0x2229
+      , 0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248
+      , 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
+    }};
+
+    auto const it = std::find(begin(cp437), end(cp437), cp);
+    return (it != end(cp437))
+      ? 0x80u + static_cast<uint32_t>(std::distance(begin(cp437), it))
+      : static_cast<uint32_t>('?');
 }
 
+//! Packs rectangles into horizontal shelves of varying height. Space freed on
+//! a shelf is reused by anything which fits in it; shelves themselves are never
+//! removed.
+class shelf_packer {
+public:
+    shelf_packer(int32_t const w, int32_t const h) noexcept
+      : w_ {w}
+      , h_ {h}
+    {
+    }
+
+    //! @returns true and the location of a free @p w x @p h area in @p out if
+    //! there is one.
+    bool allocate(int32_t const w, int32_t const h, point2i16& out) {
+        // the shortest shelf the rect fits on
+        shelf_t* best   = nullptr;
+        span_t*  best_s = nullptr;
+
+        for (auto& shelf : shelves_) {
+            if (shelf.h < h || (best && shelf.h >= best->h)) {
+                continue;
+            }
+
+            auto const it = std::find_if(begin(shelf.free), end(shelf.free)
+              , [w](span_t const& span) noexcept { return span.w >= w; });
+
+            if (it != end(shelf.free)) {
+                best   = &shelf;
+                best_s = &*it;
+            } else if (shelf.end + w <= w_) {
+                best   = &shelf;
+                best_s = nullptr;
+            }
+        }
+
+        if (!best) {
+            if (next_y_ + h > h_ || w > w_) {
+                return false;
+            }
+
+            shelves_.push_back({next_y_, h, 0, {}});
+            next_y_ += h;
+            best = &shelves_.back();
+        }
+
+        int32_t x = 0;
+        if (best_s) {
+            x = best_s->x;
+            best_s->x += w;
+            best_s->w -= w;
+            if (best_s->w == 0) {
+                best->free.erase(begin(best->free) + (best_s - best->free.data()));
+            }
+        } else {
+            x = best->end;
+            best->end += w;
+        }
+
+        out = point2i16 {static_cast<int16_t>(x), static_cast<int16_t>(best->y)};
+        return true;
+    }
+
+    //! return the @p w pixel wide area at @p p to its shelf.
+    void free(point2i16 const p, int32_t const w) {
+        auto const y = value_cast(p.y);
+        auto const shelf = std::find_if(begin(shelves_), end(shelves_)
+          , [y](shelf_t const& s) noexcept { return s.y == y; });
+
+        BK_ASSERT(shelf != end(shelves_));
+
+        auto& free = shelf->free;
+        auto const x = value_cast(p.x);
+
+        // keep the free spans sorted and coalesced
+        auto it = std::lower_bound(begin(free), end(free), x
+          , [](span_t const& span, int32_t const n) noexcept { return span.x < n; });
+
+        it = free.insert(it, span_t {x, w});
+
+        if (it + 1 != end(free) && it->x + it->w == (it + 1)->x) {
+            it->w += (it + 1)->w;
+            free.erase(it + 1);
+        }
+
+        if (it != begin(free) && (it - 1)->x + (it - 1)->w == it->x) {
+            (it - 1)->w += it->w;
+            it = free.erase(it) - 1;
+        }
+
+        if (it->x + it->w == shelf->end) {
+            shelf->end = it->x;
+            free.erase(it);
+        }
+    }
+private:
+    struct span_t {
+        int32_t x;
+        int32_t w;
+    };
+
+    struct shelf_t {
+        int32_t y;
+        int32_t h;
+        int32_t end;               //!< the start of the unused part of the shelf
+        std::vector<span_t> free;  //!< freed spans before end
+    };
+
+    std::vector<shelf_t> shelves_;
+    int32_t w_;
+    int32_t h_;
+    int32_t next_y_ = 0;
+};
+
 } //namespace anonymous
 
 //===------------------------------------------------------------------------===
@@ -32,40 +188,176 @@ text_renderer::~text_renderer() = default;
 
 class text_renderer_impl final : public text_renderer {
 public:
+    text_renderer_impl(sizei32x const atlas_w, sizei32y const atlas_h)
+      : packer_  {value_cast(atlas_w), value_cast(atlas_h)}
+      , atlas_w_ {atlas_w}
+      , atlas_h_ {atlas_h}
+    {
+    }
+
     glyph_data_t load_metrics(uint32_t const cp_prev, uint32_t const cp) noexcept final override {
         return load_metrics(cp);
     }
 
     glyph_data_t load_metrics(uint32_t const cp) noexcept final override;
 
+    void touch(uint32_t const* first, uint32_t const* last) noexcept final override;
+
     int pixel_size() const noexcept final override { return 18; }
     int ascender()   const noexcept final override { return 18; }
     int descender()  const noexcept final override { return 0; }
     int line_gap()   const noexcept final override { return 18; }
+
+    int glyph_advance() const noexcept final override { return glyph_size; }
+
+    uint32_t generation() const noexcept final override { return generation_; }
+
+    sizei32x atlas_width()  const noexcept final override { return atlas_w_; }
+    sizei32y atlas_height() const noexcept final override { return atlas_h_; }
+
+    uint32_t atlas_texture() const noexcept final override {
+        return atlas_texture_;
+    }
+
+    void set_atlas_texture(uint32_t const id) noexcept final override {
+        atlas_texture_ = id;
+    }
+
+    std::vector<glyph_copy_t> const& pending_copies() const noexcept final override {
+        return pending_;
+    }
+
+    void clear_pending_copies() noexcept final override {
+        pending_.clear();
+    }
+
+    void recopy_atlas() final override {
+        pending_.clear();
+        for (auto const& g : cache_) {
+            pending_.push_back({glyph_source_(g.first), g.second.position
+                              , point2i16 {glyph_size, glyph_size}});
+        }
+    }
+private:
+    struct entry_t {
+        point2i16 position;  //!< in the atlas
+        uint32_t  last_used; //!< the value of tick_ when last loaded or touched
+    };
+
+    //! @returns the location in the atlas of the glyph with index @p glyph,
+    //! placing it there if required.
+    point2i16 find_or_place_(uint32_t glyph);
+
+    //! @returns the location of the glyph with index @p glyph in the font
+    //! texture.
+    static point2i16 glyph_source_(uint32_t const glyph) noexcept {
+        return {static_cast<int16_t>(glyph_size * static_cast<int16_t>(glyph % glyphs_per_row))
+              , static_cast<int16_t>(glyph_size * static_cast<int16_t>(glyph / glyphs_per_row))};
+    }
+
+    //! evict the least recently used glyph; glyphs may have moved.
+    bool evict_();
+
+    std::unordered_map<uint32_t, entry_t> cache_; //!< by glyph index
+    std::vector<glyph_copy_t> pending_;
+    shelf_packer packer_;
+
+    sizei32x atlas_w_;
+    sizei32y atlas_h_;
+    uint32_t atlas_texture_ = no_texture;
+    uint32_t generation_    = 0;
+    uint32_t tick_          = 0;
 };
 
 text_renderer::glyph_data_t
 text_renderer_impl::load_metrics(uint32_t const cp) noexcept {
-    constexpr uint32_t tiles_x = 16u;
-    //constexpr int16_t tiles_y = 16;
-    constexpr sizei16x tile_w  = int16_t {18};
-    constexpr sizei16y tile_h  = int16_t {18};
-
-    auto const tex_offset = point2i16 {
-        value_cast(tile_w * static_cast<int16_t>(cp % tiles_x))
-      , value_cast(tile_h * static_cast<int16_t>(cp / tiles_x))};
-
-    auto const tex_size = point2i16 {
-        value_cast(tile_w), value_cast(tile_h)};
+    auto const tex_offset = find_or_place_(glyph_index(cp));
+    auto const tex_size   = point2i16 {glyph_size, glyph_size};
 
     auto const offset  = vec2i16 {};
-    auto const advance = vec2i16 {tile_w, int16_t {0}};
+    auto const advance = vec2i16 {glyph_size, int16_t {0}};
 
     return {tex_offset, tex_size, offset, advance};
 }
 
+void text_renderer_impl::touch(
+    uint32_t const*       first
+  , uint32_t const* const last
+) noexcept {
+    ++tick_;
+
+    for (; first != last; ++first) {
+        auto const it = cache_.find(glyph_index(*first));
+        if (it != end(cache_)) {
+            it->second.last_used = tick_;
+        }
+    }
+}
+
+point2i16 text_renderer_impl::find_or_place_(uint32_t const glyph) {
+    ++tick_;
+
+    auto const it = cache_.find(glyph);
+    if (it != end(cache_)) {
+        it->second.last_used = tick_;
+        return it->second.position;
+    }
+
+    point2i16 p;
+    while (!packer_.allocate(glyph_size, glyph_size, p)) {
+        if (!evict_()) {
+            BK_ASSERT(false); // the atlas can't hold even a single glyph
+            return {};
+        }
+    }
+
+    cache_.insert({glyph, entry_t {p, tick_}});
+    pending_.push_back({glyph_source_(glyph), p, point2i16 {glyph_size, glyph_size}});
+
+    return p;
+}
+
+bool text_renderer_impl::evict_() {
+    if (cache_.empty()) {
+        return false;
+    }
+
+    auto const it = std::min_element(begin(cache_), end(cache_)
+      , [](auto const& a, auto const& b) noexcept {
+            return a.second.last_used < b.second.last_used; });
+
+    auto const p = it->second.position;
+    packer_.free(p, glyph_size);
+    cache_.erase(it);
+
+    // the glyph may have been evicted before it was ever copied to the atlas
+    pending_.erase(std::remove_if(begin(pending_), end(pending_)
+      , [p](glyph_copy_t const& c) noexcept { return c.dest == p; })
+      , end(pending_));
+
+    ++generation_;
+    return true;
+}
+
+std::unique_ptr<text_renderer> make_text_renderer(
+    sizei32x const atlas_w
+  , sizei32y const atlas_h
+) {
+    return std::make_unique<text_renderer_impl>(atlas_w, atlas_h);
+}
+
 std::unique_ptr<text_renderer> make_text_renderer() {
-    return std::make_unique<text_renderer_impl>();
+    return make_text_renderer(sizei32x {256}, sizei32y {256});
+}
+
+sizei16x estimate_text_width(
+    text_renderer const& trender
+  , string_view    const text
+  , sizei16x       const max_width
+) noexcept {
+    auto const n = code_point_count(text.data(), text.data() + text.size());
+    auto const w = static_cast<int64_t>(n) * trender.glyph_advance();
+    return static_cast<int16_t>(std::min(w, int64_t {value_cast(max_width)}));
 }
 
 //===------------------------------------------------------------------------===
@@ -74,6 +366,8 @@ std::unique_ptr<text_renderer> make_text_renderer() {
 
 text_layout::text_layout() noexcept
   : data_          {}
+  , generation_    {}
+  , glyphs_        {}
   , text_          {}
   , position_      {}
   , max_width_     {std::numeric_limits<int16_t>::max()}
@@ -91,6 +385,8 @@ text_layout::text_layout(
   , sizei16y const max_height
 )
   : data_          {}
+  , generation_    {}
+  , glyphs_        {}
   , text_          {}
   , position_      {}
   , max_width_     {max_width}
@@ -109,6 +405,7 @@ void text_layout::layout(text_renderer& trender, std::string text) {
 
 void text_layout::layout(text_renderer& trender) {
     data_.clear();
+    generation_    = trender.generation();
     actual_width_  = sizei16x {};
     actual_height_ = sizei16y {};
 
@@ -287,8 +584,12 @@ void text_layout::layout(text_renderer& trender) {
     uint32_t prev_cp = 0;
     uint32_t cp      = 0;
 
-    auto       it   = text_.data();
-    auto const last = text_.data() + static_cast<ptrdiff_t>(text_.size());
+    // decoding is done up front so that runs of ascii can be decoded in bulk
+    std::vector<uint32_t> codepoints;
+    decode_text(text_, codepoints);
+
+    auto       it   = codepoints.data();
+    auto const last = codepoints.data() + codepoints.size();
 
     auto const read_next = [&]() noexcept {
         if (it == last) {
@@ -296,7 +597,7 @@ void text_layout::layout(text_renderer& trender) {
         }
 
         prev_cp = cp;
-        cp = next_code_point(it, last);
+        cp = *it++;
 
         return true;
     };
@@ -333,6 +634,15 @@ void text_layout::layout(text_renderer& trender) {
         case state_t::stop :
             actual_width_  = static_cast<int16_t>(std::max(actual_w, x));
             actual_height_ = static_cast<int16_t>(y + (x ? line_h : 0));
+
+            glyphs_.clear();
+            for (auto const& glyph : data_) {
+                glyphs_.push_back(glyph.codepoint);
+            }
+
+            std::sort(begin(glyphs_), end(glyphs_));
+            glyphs_.erase(std::unique(begin(glyphs_), end(glyphs_)), end(glyphs_));
+
             return;
         default :
             BK_ASSERT(false);
@@ -342,12 +652,25 @@ void text_layout::layout(text_renderer& trender) {
 }
 
 void text_layout::update(text_renderer& trender) const noexcept {
-    for (auto& glyph : data_) {
-        glyph.texture = trender.load_metrics(glyph.codepoint).texture;
+    if (trender.generation() == generation_) {
+        trender.touch(glyphs_.data(), glyphs_.data() + glyphs_.size());
+        return;
+    }
+
+    // loading a glyph can evict another, even one loaded earlier in the same
+    // pass, so the pass is repeated if the atlas changed during it. By then
+    // every glyph here is more recently used than any other, so the atlas can
+    // only change again if it can't hold them all; the next update retries.
+    for (int pass = 0; pass < 2 && trender.generation() != generation_; ++pass) {
+        generation_ = trender.generation();
+
+        for (auto& glyph : data_) {
+            glyph.texture = trender.load_metrics(glyph.codepoint).texture;
+        }
     }
 }
 
-std::vector<text_layout::data_t> const& text_layout::data() const noexcept {
+text_layout::data_container_t const& text_layout::data() const noexcept {
     return data_;
 }
 
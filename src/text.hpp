@@ -2,6 +2,7 @@
 
 #include "math_types.hpp" // for basic_2_tuple, point2i
 #include "config.hpp"     // for string_View
+#include "memory_stats.hpp"
 
 #include <memory>  // for unique_ptr
 #include <string>  // for string
@@ -19,19 +20,72 @@ public:
         vec2i16   advance;
     };
 
+    //! A glyph newly placed in the atlas; it must be copied there from the font
+    //! texture before the atlas is next drawn from.
+    struct glyph_copy_t {
+        point2i16 source; //!< the location in the font texture
+        point2i16 dest;   //!< the location in the atlas
+        point2i16 size;
+    };
+
+    //! the texture id used before the atlas has been given a texture.
+    static constexpr uint32_t no_texture = 0xFFFFFFFFu;
+
     virtual ~text_renderer();
 
+    //! load the metrics for @p cp and ensure it is resident in the atlas; the
+    //! texture location returned is relative to the atlas.
     virtual glyph_data_t load_metrics(uint32_t cp_prev, uint32_t cp) noexcept = 0;
     virtual glyph_data_t load_metrics(uint32_t cp) noexcept = 0;
 
+    //! mark the glyphs for the code points [@p first, @p last), if resident, as
+    //! used just now; glyphs which are drawn, but not loaded again, are then
+    //! evicted after those which aren't drawn at all.
+    virtual void touch(uint32_t const* first, uint32_t const* last) noexcept = 0;
+
     virtual int pixel_size() const noexcept = 0;
     virtual int ascender()   const noexcept = 0;
     virtual int descender()  const noexcept = 0;
     virtual int line_gap()   const noexcept = 0;
+
+    //! the horizontal advance of every glyph; the font is fixed width.
+    virtual int glyph_advance() const noexcept = 0;
+
+    //! incremented whenever the texture location of a previously loaded glyph
+    //! may have changed; glyph data loaded during the same generation remains
+    //! valid.
+    virtual uint32_t generation() const noexcept = 0;
+
+    virtual sizei32x atlas_width()  const noexcept = 0;
+    virtual sizei32y atlas_height() const noexcept = 0;
+
+    //! the texture the atlas has been given by the renderer, or no_texture.
+    virtual uint32_t atlas_texture() const noexcept = 0;
+    virtual void set_atlas_texture(uint32_t id) noexcept = 0;
+
+    //! glyphs placed in the atlas since the last call to clear_pending_copies.
+    virtual std::vector<glyph_copy_t> const& pending_copies() const noexcept = 0;
+    virtual void clear_pending_copies() noexcept = 0;
+
+    //! make every glyph resident in the atlas pending again, in place; required
+    //! after the contents of the atlas texture have been lost.
+    virtual void recopy_atlas() = 0;
 };
 
+//! A text_renderer with glyphs from the 16 x 16 grid of 18 pixel cells in the
+//! font texture; they are packed into an atlas of @p atlas_w x @p atlas_h
+//! pixels as they are used, evicting those least recently used as required.
+std::unique_ptr<text_renderer> make_text_renderer(sizei32x atlas_w, sizei32y atlas_h);
 std::unique_ptr<text_renderer> make_text_renderer();
 
+//! @returns the width of @p text on a single line no wider than @p max_width,
+//! without laying it out; that is, the glyph advance times the number of code
+//! points. Markup is counted as though it were text.
+sizei16x estimate_text_width(
+    text_renderer const& trender
+  , string_view          text
+  , sizei16x             max_width) noexcept;
+
 class text_layout {
 public:
     struct data_t {
@@ -72,15 +126,22 @@ public:
 
     void set_max_width(sizei32x w) noexcept;
 
-    // ensure all required glyphs are still cached at the same locations
+    // ensure all required glyphs are still cached at the same locations, and
+    // mark them as used; they are only loaded again if the glyph atlas of
+    // trender has changed since the text was last laid out or updated.
     void update(text_renderer& trender) const noexcept;
 
-    std::vector<data_t> const& data() const noexcept;
+    using data_container_t = tracked_vector<data_t, memory_tag::text>;
+
+    data_container_t const& data() const noexcept;
 
     string_view text() const noexcept;
 private:
     // glyph texture locations can change
-    std::vector<data_t> mutable data_;
+    data_container_t mutable data_;
+    uint32_t         mutable generation_;
+
+    tracked_vector<uint32_t, memory_tag::text> glyphs_; //!< the distinct code points in data_
 
     std::string text_;
     point2i16   position_;
@@ -101,10 +101,21 @@ public:
         return remove_(hash);
     }
 
+    //! @returns the earliest deadline of any timer, or time_point::max() if
+    //! there are none.
+    time_point next_deadline() const noexcept {
+        return timers_.empty()
+          ? time_point::max()
+          : timers_.front().deadline;
+    }
+
     //! Trigger any ready timers.
-    void update() {
+    //! @returns the number of timer callbacks executed.
+    size_t update() {
+        size_t count = 0;
+
         if (timers_.empty()) {
-            return;
+            return count;
         }
 
         updating_ = true;
@@ -148,6 +159,7 @@ public:
             auto const key = t.key;
 
             auto const period = callbacks_[t.key.index](dt, t.data);
+            ++count;
             BK_ASSERT(period.count() >= 0
                    && !timers_.empty()
                    && timers_.front().key == key);
@@ -177,6 +189,8 @@ public:
             timers_.back() = data;
             std::push_heap(first, last, predicate_);
         } while (!timers_.empty());
+
+        return count;
     }
 
 private:
@@ -231,7 +245,7 @@ private:
     }
 
     std::vector<data_t> timers_;
-    contiguous_fixed_size_block_storage<callback_t> callbacks_;
+    contiguous_fixed_size_block_storage<callback_t, memory_tag::ui> callbacks_;
     bool updating_ = false;
 };
 
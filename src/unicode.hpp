@@ -26,13 +26,55 @@
 // SOFTWARE.
 
 #include <iterator>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 namespace boken {
 
+namespace detail {
+
+constexpr uint32_t utf8_accept {0};
+constexpr uint32_t utf8_reject {12};
+
+//! Advance the decoder with @p state and partial code point @p codep by the
+//! single byte @p byte.
+inline void utf8_decode_byte(uint32_t& state, uint32_t& codep, uint32_t const byte) noexcept {
+    static constexpr uint8_t utf8d[] {
+      // The first part of the table maps bytes to character classes that
+      // to reduce the size of the transition table and create bitmasks.
+       0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+       0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+       0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+       0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+       1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,  9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+       7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,  7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+       8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2,  2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+      10,3,3,3,3,3,3,3,3,3,3,3,3,4,3,3, 11,6,6,6,5,8,8,8,8,8,8,8,8,8,8,8,
+
+      // The second part is a transition table that maps a combination
+      // of a state of the automaton and a character class to a state.
+       0,12,24,36,60,96,84,12,12,12,48,72, 12,12,12,12,12,12,12,12,12,12,12,12,
+      12, 0,12,12,12,12,12, 0,12, 0,12,12, 12,24,12,12,12,12,12,24,12,24,12,12,
+      12,12,12,12,12,12,12,24,12,12,12,12, 12,24,12,12,12,12,12,12,12,24,12,12,
+      12,12,12,12,12,12,12,36,12,36,12,12, 12,36,12,12,12,12,12,36,12,36,12,12,
+      12,36,12,12,12,12,12,12,12,12,12,12
+    };
+
+    uint32_t const type = utf8d[byte];
+
+    codep = (state != utf8_accept)
+          ? (byte & 0x3Fu) | (codep << 6u)
+          : (0xFFu >> type) & (byte);
+
+    state = utf8d[256u + state + type];
+}
+
+} //namespace detail
+
 class utf8_decoder_iterator : public std::iterator<std::forward_iterator_tag, uint32_t> {
-    static constexpr uint32_t UTF8_ACCEPT {0};
-    static constexpr uint32_t UTF8_REJECT {12};
+    static constexpr uint32_t UTF8_ACCEPT {detail::utf8_accept};
+    static constexpr uint32_t UTF8_REJECT {detail::utf8_reject};
 public:
     utf8_decoder_iterator() noexcept = default;
     explicit utf8_decoder_iterator(char const* const s) noexcept
@@ -63,35 +105,7 @@ public:
     }
 private:
     void next_byte_() noexcept {
-        static constexpr uint8_t utf8d_[] {
-          // The first part of the table maps bytes to character classes that
-          // to reduce the size of the transition table and create bitmasks.
-           0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-           0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-           0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-           0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-           1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,  9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
-           7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,  7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
-           8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2,  2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
-          10,3,3,3,3,3,3,3,3,3,3,3,3,4,3,3, 11,6,6,6,5,8,8,8,8,8,8,8,8,8,8,8,
-
-          // The second part is a transition table that maps a combination
-          // of a state of the automaton and a character class to a state.
-           0,12,24,36,60,96,84,12,12,12,48,72, 12,12,12,12,12,12,12,12,12,12,12,12,
-          12, 0,12,12,12,12,12, 0,12, 0,12,12, 12,24,12,12,12,12,12,24,12,24,12,12,
-          12,12,12,12,12,12,12,24,12,12,12,12, 12,24,12,12,12,12,12,12,12,24,12,12,
-          12,12,12,12,12,12,12,36,12,36,12,12, 12,36,12,12,12,12,12,36,12,36,12,12,
-          12,36,12,12,12,12,12,12,12,12,12,12
-        };
-
-        uint32_t const byte = static_cast<uint8_t>(*s_++);
-        uint32_t const type = utf8d_[byte];
-
-        codep_ = (state_ != UTF8_ACCEPT)
-               ? (byte & 0x3Fu) | (codep_ << 6u)
-               : (0xFFu >> type) & (byte);
-
-        state_ = utf8d_[256u + state_ + type];
+        detail::utf8_decode_byte(state_, codep_, static_cast<uint8_t>(*s_++));
     }
 
     void next_cp_() noexcept {
@@ -121,4 +135,76 @@ inline utf8_decoder_iterator end(utf8_decoder_iterator) noexcept {
     return {};
 }
 
+//! Decode the UTF-8 text in [@p first, @p last) to the code points @p out.
+//! Runs of ASCII are copied a word at a time; only multi-byte sequences go
+//! through the decoder proper. Unlike utf8_decoder_iterator, a nul is decoded
+//! like any other character rather than ending the text.
+//! @returns @p last, or the start of the first invalid or incomplete sequence
+//! where decoding stopped; every code point before it has been written.
+template <typename OutIt>
+char const* decode(char const* first, char const* const last, OutIt out) {
+    constexpr uint64_t high_bits = 0x8080808080808080u;
+
+    while (first != last) {
+        while (last - first >= 8) {
+            uint64_t word;
+            std::memcpy(&word, first, sizeof(word));
+            if (word & high_bits) {
+                break;
+            }
+
+            for (int i = 0; i < 8; ++i) {
+                *out = static_cast<uint8_t>(first[i]);
+                ++out;
+            }
+
+            first += 8;
+        }
+
+        if (first == last) {
+            break;
+        }
+
+        auto const byte = static_cast<uint8_t>(*first);
+        if (!(byte & 0x80u)) {
+            *out = byte;
+            ++out;
+            ++first;
+            continue;
+        }
+
+        uint32_t state = detail::utf8_accept;
+        uint32_t codep = 0;
+
+        auto it = first;
+        do {
+            detail::utf8_decode_byte(state, codep, static_cast<uint8_t>(*it++));
+        } while (it != last
+              && state != detail::utf8_accept
+              && state != detail::utf8_reject);
+
+        if (state != detail::utf8_accept) {
+            return first;
+        }
+
+        *out = codep;
+        ++out;
+        first = it;
+    }
+
+    return last;
+}
+
+//! @returns the number of code points in the UTF-8 text [@p first, @p last)
+//! without decoding it; each byte which isn't a continuation byte is counted
+//! as the start of one. For valid text this is exact.
+inline size_t code_point_count(char const* first, char const* const last) noexcept {
+    size_t n = 0;
+    for (; first != last; ++first) {
+        n += (static_cast<uint8_t>(*first) & 0xC0u) != 0x80u;
+    }
+
+    return n;
+}
+
 } //namespace boken
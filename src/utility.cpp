@@ -1,6 +1,12 @@
 #include "utility.hpp"
 #include "format.hpp"
+
+#include "bkassert/assert.hpp"
+
+#include <algorithm>
+#include <cmath>
 #include <cstdarg>
+#include <cstring>
 
 namespace boken {
 
@@ -60,4 +66,180 @@ bool string_buffer_base::append(char const* const fmt, ...) noexcept {
     return result;
 }
 
+//===------------------------------------------------------------------------===
+//                          typed formatting
+//===------------------------------------------------------------------------===
+namespace {
+
+constexpr char digit_pairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+constexpr char hex_digits[] = "0123456789abcdef";
+
+constexpr uint64_t powers_of_10[] {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u
+  , 1000000000u
+};
+
+//! write the decimal digits of @p n ending just before @p last.
+//! @returns a pointer to the first digit written.
+char* write_digits(char* last, uint64_t n) noexcept {
+    while (n >= 100u) {
+        auto const i = n % 100u * 2u;
+        n /= 100u;
+        *--last = digit_pairs[i + 1u];
+        *--last = digit_pairs[i];
+    }
+
+    if (n >= 10u) {
+        auto const i = n * 2u;
+        *--last = digit_pairs[i + 1u];
+        *--last = digit_pairs[i];
+    } else {
+        *--last = static_cast<char>('0' + n);
+    }
+
+    return last;
+}
+
+} // namespace
+
+bool string_buffer_base::write_string(char const* const s, size_t const n) noexcept {
+    auto const last = capacity_ - 1;
+    if (!data_ || first_ >= last) {
+        return false;
+    }
+
+    auto const m = std::min(n, static_cast<size_t>(last - first_));
+    std::memcpy(data_ + first_, s, m);
+
+    first_ += static_cast<ptrdiff_t>(m);
+    data_[first_] = '\0';
+
+    return m == n;
+}
+
+bool string_buffer_base::write_uint(uint64_t const n) noexcept {
+    char digits[20];
+    auto const last  = std::end(digits);
+    auto const first = write_digits(last, n);
+
+    return write_string(first, static_cast<size_t>(last - first));
+}
+
+bool string_buffer_base::write_int(int64_t const n) noexcept {
+    if (n >= 0) {
+        return write_uint(static_cast<uint64_t>(n));
+    }
+
+    return write_string("-", 1u)
+        && write_uint(uint64_t {0} - static_cast<uint64_t>(n));
+}
+
+bool string_buffer_base::write_fixed(double const n, int const digits) noexcept {
+    if (std::isnan(n)) {
+        return write_string("nan", 3u);
+    } else if (std::isinf(n)) {
+        return (n < 0.0) ? write_string("-inf", 4u) : write_string("inf", 3u);
+    }
+
+    auto const d     = std::min(std::max(digits, 0), 9);
+    auto const scale = powers_of_10[d];
+    auto const x     = std::abs(n) * static_cast<double>(scale) + 0.5;
+
+    // too big to be done exactly with integers
+    if (x >= 9.0e18) {
+        return append("%.*f", d, n);
+    }
+
+    auto const r = static_cast<uint64_t>(x);
+
+    if (n < 0.0 && r && !write_string("-", 1u)) {
+        return false;
+    }
+
+    if (!write_uint(r / scale)) {
+        return false;
+    }
+
+    if (!d) {
+        return true;
+    }
+
+    // the fractional part, zero padded
+    char frac[10] = {'.', '0', '0', '0', '0', '0', '0', '0', '0', '0'};
+    auto const last = frac + 1 + d;
+    write_digits(last, r % scale);
+
+    return write_string(frac, static_cast<size_t>(d + 1));
+}
+
+bool string_buffer_base::write_hex(uint64_t n, int const digits) noexcept {
+    char buffer[2 + 16] = {'0', 'x'};
+    auto const last = std::end(buffer);
+    auto first = last;
+
+    do {
+        *--first = hex_digits[n & 0xFu];
+        n >>= 4;
+    } while (n);
+
+    auto const min_digits = std::min(std::max(digits, 0), 16);
+    while (last - first < min_digits) {
+        *--first = '0';
+    }
+
+    *--first = 'x';
+    *--first = '0';
+
+    return write_string(first, static_cast<size_t>(last - first));
+}
+
+ptrdiff_t detail::format_placeholder_count(char const* const fmt) noexcept {
+    ptrdiff_t n = 0;
+
+    for (auto p = std::strchr(fmt, '{'); p; p = std::strchr(p + 2, '{')) {
+        if (p[1] == '}') {
+            ++n;
+        } else if (p[1] != '{') {
+            return -1;
+        }
+    }
+
+    return n;
+}
+
+bool string_buffer_base::format_next_(char const*& fmt) noexcept {
+    for (auto first = fmt; ; ) {
+        auto const p = std::strchr(first, '{');
+        if (!p) {
+            auto const n = std::strlen(first);
+            fmt = first + n;
+            return write_string(first, n);
+        }
+
+        if (!write_string(first, static_cast<size_t>(p - first))) {
+            return false;
+        }
+
+        if (p[1] == '{') {
+            if (!write_string("{", 1u)) {
+                return false;
+            }
+
+            first = p + 2;
+            continue;
+        }
+
+        BK_ASSERT(p[1] == '}');
+
+        fmt = p + 2;
+        return true;
+    }
+}
+
 } //namespace boken
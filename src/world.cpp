@@ -37,7 +37,7 @@ public:
         return entity_deleter_;
     }
 
-    unique_item create_object(std::function<item (item_instance_id)> const& f) final override {
+    unique_item create_object(function_ref<item (item_instance_id)> f) final override {
         auto const id = item_instance_id {static_cast<uint32_t>(items_.next_block_id())};
         auto const result = items_.allocate(f(id));
 
@@ -45,7 +45,7 @@ public:
 
         return unique_item {id, item_deleter_};
     }
-    unique_entity create_object(std::function<entity (entity_instance_id)> const& f) final override {
+    unique_entity create_object(function_ref<entity (entity_instance_id)> f) final override {
         auto const id = entity_instance_id {static_cast<uint32_t>(entities_.next_block_id())};
         auto const result = entities_.allocate(f(id));
 
@@ -54,6 +54,20 @@ public:
         return unique_entity {id, entity_deleter_};
     }
 
+    std::vector<unique_item> create_objects(
+        size_t const n
+      , function_ref<item (item_instance_id)> f
+    ) final override {
+        return create_objects_(items_, item_deleter_, n, f);
+    }
+
+    std::vector<unique_entity> create_objects(
+        size_t const n
+      , function_ref<entity (entity_instance_id)> f
+    ) final override {
+        return create_objects_(entities_, entity_deleter_, n, f);
+    }
+
     int total_levels() const noexcept final override {
         return static_cast<int>(levels_.size());
     }
@@ -86,11 +100,38 @@ public:
         return current_level();
     }
 private:
+    template <typename Deleter>
+    using unique_t = std::unique_ptr<typename Deleter::pointer, Deleter const&>;
+
+    template <typename Storage, typename Deleter, typename F>
+    static std::vector<unique_t<Deleter>> create_objects_(
+        Storage&       storage
+      , Deleter const& deleter
+      , size_t const   n
+      , F const&       f
+    ) {
+        using id_t     = typename Deleter::pointer;
+        using result_t = unique_t<Deleter>;
+
+        std::vector<result_t> result;
+        result.reserve(n);
+
+        auto const first = storage.allocate_n(n, [&](size_t const i) {
+            return f(id_t {static_cast<uint32_t>(i)});
+        });
+
+        for (size_t i = 0; i < n; ++i) {
+            result.emplace_back(id_t {static_cast<uint32_t>(first + i)}, deleter);
+        }
+
+        return result;
+    }
+
     item_deleter   item_deleter_   {*this};
     entity_deleter entity_deleter_ {*this};
 
-    contiguous_fixed_size_block_storage<item>   items_;
-    contiguous_fixed_size_block_storage<entity> entities_;
+    contiguous_fixed_size_block_storage<item,   memory_tag::world> items_;
+    contiguous_fixed_size_block_storage<entity, memory_tag::world> entities_;
 
     size_t current_level_index_ {0};
     std::vector<std::unique_ptr<level>> levels_;
@@ -154,14 +195,22 @@ entity const& find(world const& w, entity_instance_id const id) noexcept {
     return w.find(id);
 }
 
-unique_item create_object(world& w, std::function<item (item_instance_id)> const& f) {
+unique_item create_object(world& w, function_ref<item (item_instance_id)> f) {
     return w.create_object(f);
 }
 
-unique_entity create_object(world& w, std::function<entity (entity_instance_id)> const& f) {
+unique_entity create_object(world& w, function_ref<entity (entity_instance_id)> f) {
     return w.create_object(f);
 }
 
+std::vector<unique_item> create_objects(world& w, size_t const n, function_ref<item (item_instance_id)> f) {
+    return w.create_objects(n, f);
+}
+
+std::vector<unique_entity> create_objects(world& w, size_t const n, function_ref<entity (entity_instance_id)> f) {
+    return w.create_objects(n, f);
+}
+
 item_deleter const& get_item_deleter(world const& w) noexcept {
     return w.get_item_deleter();
 }
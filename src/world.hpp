@@ -1,8 +1,10 @@
 #pragma once
 
 #include "types.hpp"
+#include "functional.hpp"
+
 #include <memory>
-#include <functional>
+#include <vector>
 
 namespace boken { class item; }
 namespace boken { class entity; }
@@ -38,8 +40,21 @@ public:
     //! @note    References returned by @ref find can be invalidated by a call
     //!          to this function.
 
-    virtual unique_item   create_object(std::function<item   (item_instance_id)>   const& f) = 0;
-    virtual unique_entity create_object(std::function<entity (entity_instance_id)> const& f) = 0;
+    virtual unique_item   create_object(function_ref<item   (item_instance_id)>   f) = 0;
+    virtual unique_entity create_object(function_ref<entity (entity_instance_id)> f) = 0;
+
+    //@}
+
+    //@{
+    //! Create @p n objects in a single step; storage for all of them is
+    //! reserved once, and each is constructed in place from @p f(id).
+    //! @returns Owning handles to the new objects; the ids are contiguous and
+    //!          in ascending order.
+    //! @note    References returned by @ref find can be invalidated by a call
+    //!          to this function.
+
+    virtual std::vector<unique_item>   create_objects(size_t n, function_ref<item   (item_instance_id)>   f) = 0;
+    virtual std::vector<unique_entity> create_objects(size_t n, function_ref<entity (entity_instance_id)> f) = 0;
 
     //@}
 